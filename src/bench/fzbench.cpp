@@ -0,0 +1,185 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <streambuf>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/FlatZincMX.hpp"
+#include "flatzincsupport/ParseContext.hpp"
+#include "flatzincsupport/JsonParser.hpp"
+#include "flatzincsupport/flatzincparser.h"
+#include "flatzincsupport/fzexception.hpp"
+#include "flatzincsupport/Statistics.hpp"
+using namespace std;
+
+/**
+ * Measures the throughput of the translator on one flatzinc file.
+ * The translator keeps its symbol tables in globals, so every file is measured in a separate process.
+ */
+
+extern int fzlex(YYSTYPE* value, void* scanner);
+
+// Discards the output but counts it
+class CountingBuffer: public streambuf{
+private:
+	char buffer[1<<16];
+	long long count;
+public:
+	CountingBuffer(): count(0){ setp(buffer, buffer+sizeof(buffer)); }
+	long long bytes() { return count+(pptr()-pbase()); }
+protected:
+	int overflow(int c){
+		count += pptr()-pbase();
+		setp(buffer, buffer+sizeof(buffer));
+		if(c!=EOF){
+			sputc(c);
+		}
+		return c==EOF?0:c;
+	}
+};
+
+// Counts the items of a JSON model, which are built and deleted as there is no separate lexer
+class CountingHandler: public FZ::ItemHandler{
+public:
+	long long items;
+	CountingHandler(): items(0){}
+	void start(){}
+	void add(FZ::Var*){ items++; }
+	void add(FZ::Constraint*){ items++; }
+	void add(FZ::Search*){ items++; }
+};
+
+double now(){
+	timeval time;
+	gettimeofday(&time, NULL);
+	return time.tv_sec+time.tv_usec/1000000.0;
+}
+
+// Only scans the input, returns the number of items
+// FlatZinc JSON has no separate lexer, so its items are counted by the whole front end and json is set
+long long lexonly(const string& inputfile, bool& json){
+	FILE* in = fopen(inputfile.c_str(), "r");
+	if(in==NULL){
+		throw fzexception("File could not be opened, aborting.\n");
+	}
+	string input;
+	json = FZ::readJson(in, input);
+	if(json){
+		fclose(in);
+		CountingHandler handler;
+		FZ::parseJson(input.data(), input.data()+input.size(), handler);
+		return handler.items;
+	}
+	FZ::ParseContext context(in, NULL);
+	void* scanner;
+	fzlex_init_extra(&context, &scanner);
+	long long items = 0;
+	int token;
+	YYSTYPE value;
+	while((token = fzlex(&value, scanner))!=0){
+		if(token==';'){
+			items++;
+		}else if(token==IDENT || token==STRING_LITERAL){
+			delete(value.string_val);
+		}
+	}
+	fzlex_destroy(scanner);
+	fclose(in);
+	return items;
+}
+
+double rate(double amount, double seconds){
+	return seconds>0?amount/seconds:0;
+}
+
+void usage(){
+	cout << "Usage:\n"
+		 << "   fzbench [-h] [filename]\n\n"
+		 << "Prints: name, input bytes, items, seconds for lexing alone, seconds for the front end,\n"
+		 << "translating and writing, lexing and end-to-end MB/s, end-to-end items/s, output bytes and peak RSS in KB.\n"
+		 << "Lexing alone is a separate run, the other phases are timed within one translation, so they add up.\n"
+		 << "The front end reads the input and builds the items. FlatZinc JSON has no separate lexer, its lexing columns are -.\n";
+}
+
+int main(int argc, char* argv[]) {
+	if(argc!=2 || string(argv[1])=="-h" || string(argv[1])=="--help"){
+		usage();
+		return argc==2?0:1;
+	}
+	string inputfile(argv[1]);
+	struct stat info;
+	if(stat(inputfile.c_str(), &info)!=0){
+		cerr <<"File could not be opened, aborting.\n";
+		return 1;
+	}
+	double megabytes = info.st_size/(1024.0*1024.0);
+
+	CountingBuffer output;
+	streambuf* original = cout.rdbuf(&output);
+	FZ::Statistics& stats = FZ::getStatistics();
+	double lextime;
+	long long items;
+	bool json;
+	try{
+		double start = now();
+		items = lexonly(inputfile, json);
+		lextime = now()-start;
+
+		stats.enabled = true;
+		FZ::FlatZincMX* mx = new FZ::FlatZincMX();
+		mx->parse(false, inputfile);
+		mx->writeout();
+		cout.flush();
+		delete(mx);
+	}catch(const fzexception& e){
+		cout.rdbuf(original);
+		cerr <<e.what();
+		return 1;
+	}
+	cout.rdbuf(original);
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	double fronttime = stats.phasetime[FZ::PHASE_PARSING];
+	double transltime = stats.phasetime[FZ::PHASE_DECLARATIONS]+stats.phasetime[FZ::PHASE_CONSTRAINTS];
+	double writetime = stats.phasetime[FZ::PHASE_OUTPUT];
+	double total = fronttime+transltime+writetime;
+	cout <<fixed <<setprecision(3)
+		 <<inputfile
+		 <<"\t" <<info.st_size
+		 <<"\t" <<items;
+	if(json){
+		cout <<"\t-";
+	}else{
+		cout <<"\t" <<lextime;
+	}
+	cout <<"\t" <<fronttime
+		 <<"\t" <<transltime
+		 <<"\t" <<writetime
+		 <<setprecision(2);
+	if(json){
+		cout <<"\t-";
+	}else{
+		cout <<"\t" <<rate(megabytes, lextime);
+	}
+	cout <<"\t" <<rate(megabytes, total)
+		 <<"\t" <<setprecision(0) <<rate(items, total)
+		 <<"\t" <<output.bytes()
+		 <<"\t" <<usage.ru_maxrss
+		 <<"\n";
+	return 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * Deterministic generator of synthetic flatzinc models, used to benchmark the translator.
+ * The same options and seed always give the same model, independent of the platform.
+ */
+
+struct GenOptions{
+	int bools, ints, domain;
+	int arrays, arraysize;
+	int constraints;
+	int clauseweight, linweight, reifweight, boolweight;
+	double annotations;
+	string solve;
+	unsigned long long seed;
+	bool json;
+
+	GenOptions(): bools(1000), ints(1000), domain(10), arrays(10), arraysize(20), constraints(5000),
+			clauseweight(1), linweight(1), reifweight(1), boolweight(1), annotations(0), solve("satisfy"), seed(1), json(false){}
+};
+
+// xorshift64*
+class Random{
+private:
+	unsigned long long state;
+public:
+	Random(unsigned long long seed): state(seed==0?1:seed){}
+	unsigned long long next(){
+		state ^= state>>12;
+		state ^= state<<25;
+		state ^= state>>27;
+		return state*2685821657736338717ULL;
+	}
+	int below(int max){ return max<=0?0:(int)(next()%max); }
+	bool chance(double p){ return (next()>>11)*(1.0/9007199254740992.0) < p; }
+};
+
+void usage(){
+	cout << "Usage:\n"
+		 << "   fzgen [options]\n\n";
+	cout << "Options:\n";
+	cout << "    --bools=N            number of boolean variables (1000)\n";
+	cout << "    --ints=N             number of integer variables (1000)\n";
+	cout << "    --domain=N           integer variables range over 0..N (10)\n";
+	cout << "    --arrays=N           number of integer variable arrays (10)\n";
+	cout << "    --arraysize=N        number of elements per array (20)\n";
+	cout << "    --constraints=N      number of constraints (5000)\n";
+	cout << "    --mix=C,L,R,B        relative weights of bool_clause, int_lin_*, reified int and boolean constraints (1,1,1,1)\n";
+	cout << "    --annotations=P      probability of annotating an item (0)\n";
+	cout << "    --solve=KIND         satisfy, minimize or maximize (satisfy)\n";
+	cout << "    --seed=N             random seed (1)\n";
+	cout << "    --json               write the model as FlatZinc JSON, the same seed gives the same model\n";
+	cout << "    -h, --help           show this help message\n\n";
+}
+
+bool readOption(const string& arg, const string& name, string& value){
+	if(arg.compare(0, name.size()+1, name+"=")!=0){
+		return false;
+	}
+	value = arg.substr(name.size()+1);
+	return true;
+}
+
+GenOptions read_options(int argc, char* argv[]){
+	GenOptions options;
+	for(int i=1; i<argc; ++i){
+		string str(argv[i]), value;
+		if(str == "-h" || str == "--help")				{ usage(); exit(0); }
+		else if(str == "--json")						{ options.json = true; }
+		else if(readOption(str, "--bools", value))		{ options.bools = atoi(value.c_str()); }
+		else if(readOption(str, "--ints", value))		{ options.ints = atoi(value.c_str()); }
+		else if(readOption(str, "--domain", value))		{ options.domain = atoi(value.c_str()); }
+		else if(readOption(str, "--arrays", value))		{ options.arrays = atoi(value.c_str()); }
+		else if(readOption(str, "--arraysize", value))	{ options.arraysize = atoi(value.c_str()); }
+		else if(readOption(str, "--constraints", value)){ options.constraints = atoi(value.c_str()); }
+		else if(readOption(str, "--annotations", value)){ options.annotations = atof(value.c_str()); }
+		else if(readOption(str, "--solve", value))		{ options.solve = value; }
+		else if(readOption(str, "--seed", value))		{ options.seed = strtoull(value.c_str(), NULL, 10); }
+		else if(readOption(str, "--mix", value)){
+			if(sscanf(value.c_str(), "%d,%d,%d,%d", &options.clauseweight, &options.linweight, &options.reifweight, &options.boolweight)!=4){
+				cerr <<"Incorrect mix " <<value <<"\n"; exit(1);
+			}
+		}
+		else{ cerr <<"Unknown option " <<str <<"\n"; exit(1); }
+	}
+	if(options.bools<2 || options.ints<2 || options.domain<1){
+		cerr <<"At least two boolean and two integer variables are needed.\n"; exit(1);
+	}
+	if(options.solve!="satisfy" && options.solve!="minimize" && options.solve!="maximize"){
+		cerr <<"Incorrect solve kind " <<options.solve <<"\n"; exit(1);
+	}
+	return options;
+}
+
+class Generator{
+private:
+	const GenOptions& options;
+	Random random;
+	ostream& out;
+	vector<string> outputs;	// The output variables and arrays of a JSON model
+
+	// In JSON, a variable in an argument is its name as a string
+	string ref(const string& name) const { return options.json?"\""+name+"\"":name; }
+	string boolvar(){ stringstream ss; ss <<"b" <<random.below(options.bools); return ref(ss.str()); }
+	string intvar(){ stringstream ss; ss <<"x" <<random.below(options.ints); return ref(ss.str()); }
+
+	void varAnnotations(const string& name){
+		if(random.chance(options.annotations)){
+			bool output = random.below(2)==0;
+			if(!options.json){
+				out <<(output?" :: output_var":" :: var_is_introduced :: is_defined_var");
+			}else if(output){
+				outputs.push_back(name);
+			}else{
+				out <<", \"introduced\": true, \"defined\": true";
+			}
+		}
+	}
+	void constraintAnnotations(){
+		if(random.chance(options.annotations)){
+			if(options.json){
+				out <<", \"defines\": " <<intvar();
+			}else{
+				out <<" :: defines_var(" <<intvar() <<")";
+			}
+		}
+	}
+
+	void open(const string& name){
+		if(options.json){
+			out <<"{\"id\": \"" <<name <<"\", \"args\": [";
+		}else{
+			out <<"constraint " <<name <<"(";
+		}
+	}
+	void close(){ out <<(options.json?"]":")"); }
+
+	void boolList(int size){
+		out <<"[";
+		for(int i=0; i<size; ++i){
+			out <<(i==0?"":", ") <<boolvar();
+		}
+		out <<"]";
+	}
+
+	void clause(){
+		open("bool_clause");
+		boolList(1+random.below(4));
+		out <<", ";
+		int negatives = random.below(4);
+		if(negatives==0){
+			out <<ref("e");
+		}else{
+			boolList(negatives);
+		}
+		close();
+	}
+
+	void linear(){
+		int size = 2+random.below(7);
+		bool reif = random.below(4)==0;
+		static const char* ops[] = {"int_lin_le", "int_lin_eq", "int_lin_ne"};
+		open(string(ops[random.below(3)])+(reif?"_reif":""));
+		out <<"[";
+		int sum = 0;
+		for(int i=0; i<size; ++i){
+			int weight = random.below(11)-5;
+			if(weight==0){ weight = 1; }
+			sum += weight*random.below(options.domain+1);
+			out <<(i==0?"":", ") <<weight;
+		}
+		out <<"], [";
+		for(int i=0; i<size; ++i){
+			out <<(i==0?"":", ") <<intvar();
+		}
+		out <<"], " <<sum;
+		if(reif){
+			out <<", " <<boolvar();
+		}
+		close();
+	}
+
+	void reified(){
+		static const char* ops[] = {"int_eq_reif", "int_le_reif", "int_lt_reif", "int_ne_reif"};
+		open(ops[random.below(4)]);
+		out <<intvar() <<", ";
+		if(random.below(2)==0){
+			out <<intvar();
+		}else{
+			out <<random.below(options.domain+1);
+		}
+		out <<", " <<boolvar();
+		close();
+	}
+
+	void boolean(){
+		static const char* ops[] = {"bool_and", "bool_or", "bool_xor", "bool_eq_reif", "bool_le_reif", "array_bool_or", "array_bool_and", "bool2int"};
+		int op = random.below(8);
+		open(ops[op]);
+		if(op<5){
+			out <<boolvar() <<", " <<boolvar() <<", " <<boolvar();
+		}else if(op<7){
+			boolList(2+random.below(6));
+			out <<", " <<boolvar();
+		}else{
+			out <<boolvar() <<", " <<intvar();
+		}
+		close();
+	}
+
+public:
+	Generator(const GenOptions& options, ostream& out): options(options), random(options.seed), out(out){}
+
+	void generate(){
+		const char* separator = options.json?",\n":";\n";
+		if(options.json){
+			out <<"{\n\"variables\": {\n";
+		}
+		for(int i=0; i<options.bools; ++i){
+			stringstream name;
+			name <<"b" <<i;
+			if(options.json){
+				out <<(i==0?"":",\n") <<"\"" <<name.str() <<"\": {\"type\": \"bool\"";
+				varAnnotations(name.str());
+				out <<"}";
+			}else{
+				out <<"var bool: " <<name.str();
+				varAnnotations(name.str());
+				out <<";\n";
+			}
+		}
+		for(int i=0; i<options.ints; ++i){
+			stringstream name;
+			name <<"x" <<i;
+			if(options.json){
+				out <<",\n\"" <<name.str() <<"\": {\"type\": \"int\", \"domain\": [[0, " <<options.domain <<"]]";
+				varAnnotations(name.str());
+				out <<"}";
+			}else{
+				out <<"var 0.." <<options.domain <<": " <<name.str();
+				varAnnotations(name.str());
+				out <<";\n";
+			}
+		}
+		// Clauses without negative literals use the empty array e
+		if(options.json){
+			out <<"\n},\n\"arrays\": {\n\"e\": {\"a\": []}";
+		}else{
+			out <<"array [1..0] of var bool: e = [];\n";
+		}
+		for(int i=0; i<options.arrays; ++i){
+			stringstream name;
+			name <<"a" <<i;
+			bool output = random.chance(options.annotations);
+			if(options.json){
+				if(output){
+					outputs.push_back(name.str());
+				}
+				out <<",\n\"" <<name.str() <<"\": {\"a\": [";
+			}else{
+				out <<"array [1.." <<options.arraysize <<"] of var int: " <<name.str();
+				if(output){
+					out <<" :: output_array([1.." <<options.arraysize <<"])";
+				}
+				out <<" = [";
+			}
+			for(int j=0; j<options.arraysize; ++j){
+				out <<(j==0?"":", ") <<intvar();
+			}
+			out <<(options.json?"]}":"];\n");
+		}
+		if(options.json){
+			out <<"\n},\n\"constraints\": [\n";
+		}
+
+		int total = options.clauseweight+options.linweight+options.reifweight+options.boolweight;
+		if(total<=0){
+			total = 1;
+		}
+		for(int i=0; i<options.constraints; ++i){
+			if(options.json && i>0){
+				out <<separator;
+			}
+			int kind = random.below(total);
+			if(kind<options.clauseweight){
+				clause();
+			}else if(kind<options.clauseweight+options.linweight){
+				linear();
+			}else if(kind<options.clauseweight+options.linweight+options.reifweight){
+				reified();
+			}else{
+				boolean();
+			}
+			constraintAnnotations();
+			out <<(options.json?"}":separator);
+		}
+
+		if(options.json){
+			out <<"\n],\n\"output\": [";
+			for(vector<string>::const_iterator i=outputs.begin(); i<outputs.end(); ++i){
+				out <<(i==outputs.begin()?"":", ") <<ref(*i);
+			}
+			out <<"],\n\"solve\": {\"method\": \"" <<options.solve <<"\"";
+			if(random.chance(options.annotations)){
+				out <<", \"ann\": [{\"id\": \"int_search\", \"args\": [[" <<intvar() <<", " <<intvar()
+					<<"], \"input_order\", \"indomain_min\", \"complete\"]}]";
+			}
+			if(options.solve!="satisfy"){
+				out <<", \"objective\": \"x0\"";
+			}
+			out <<"}\n}\n";
+			return;
+		}
+		out <<"solve ";
+		if(random.chance(options.annotations)){
+			out <<":: int_search([" <<intvar() <<", " <<intvar() <<"], input_order, indomain_min, complete) ";
+		}
+		out <<options.solve;
+		if(options.solve!="satisfy"){
+			out <<" x0";
+		}
+		out <<";\n";
+	}
+};
+
+int main(int argc, char* argv[]) {
+	GenOptions options = read_options(argc, argv);
+	Generator(options, cout).generate();
+	return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Copyright 2011 Katholieke Universiteit Leuven
+# Use of this software is governed by the GNU LGPLv3.0 license
+# Written by Broes De Cat, K.U.Leuven, Departement
+# Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+#
+# Generates the benchmark models and measures the translator on each of them.
+# Usage: runbench.sh path/to/fzgen path/to/fzbench [scale]
+
+FZGEN=$1
+FZBENCH=$2
+SCALE=${3:-1}
+
+if test -z "$FZGEN" || test -z "$FZBENCH"; then
+	echo "Usage: runbench.sh fzgen fzbench [scale]"
+	exit 1
+fi
+
+DIR=`mktemp -d ${TMPDIR:-/tmp}/fzbench.XXXXXX` || exit 1
+trap 'rm -rf "$DIR"' 0 1 2 15
+
+# name and generator options of each workload shape
+bench() {
+	NAME=$1
+	shift
+	$FZGEN "$@" > "$DIR/$NAME.fzn" || exit 1
+	$FZBENCH "$DIR/$NAME.fzn" | sed "s|^$DIR/||"
+}
+
+# The same, with the model written as FlatZinc JSON
+benchjson() {
+	NAME=$1
+	shift
+	$FZGEN --json "$@" > "$DIR/$NAME.json" || exit 1
+	$FZBENCH "$DIR/$NAME.json" | sed "s|^$DIR/||"
+}
+
+printf "model\tbytes\titems\tlex_s\tfront_s\ttransl_s\twrite_s\tlex_MB/s\tMB/s\titems/s\tout_bytes\tpeak_KB\n"
+bench clauses  --bools=`expr 100000 \* $SCALE` --ints=2 --arrays=0 --constraints=`expr 300000 \* $SCALE` --mix=1,0,0,0
+bench linear   --bools=2 --ints=`expr 50000 \* $SCALE` --domain=100 --arrays=0 --constraints=`expr 100000 \* $SCALE` --mix=0,1,0,0
+bench reified  --bools=`expr 50000 \* $SCALE` --ints=`expr 50000 \* $SCALE` --arrays=0 --constraints=`expr 200000 \* $SCALE` --mix=0,0,1,0
+bench arrays   --bools=2 --ints=`expr 20000 \* $SCALE` --arrays=`expr 200 \* $SCALE` --arraysize=500 --constraints=1000
+bench mixed    --bools=`expr 50000 \* $SCALE` --ints=`expr 50000 \* $SCALE` --constraints=`expr 200000 \* $SCALE` --annotations=0.5 --solve=minimize
+benchjson mixed   --bools=`expr 50000 \* $SCALE` --ints=`expr 50000 \* $SCALE` --constraints=`expr 200000 \* $SCALE` --annotations=0.5 --solve=minimize
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/Components.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+
+#include "flatzincsupport/StatementBuffer.hpp"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+namespace{
+
+enum STATEMENT_KIND { STATEMENT_DECLARATION, STATEMENT_FIXED, STATEMENT_NORMAL, STATEMENT_MINIMIZE };
+
+int findRoot(vector<int>& parents, int node){
+	while(parents[node]!=node){
+		parents[node] = parents[parents[node]];
+		node = parents[node];
+	}
+	return node;
+}
+
+}
+
+int FZ::splitComponents(const StatementBuffer& statements, const string& prefix){
+	// The nodes of each statement as offsets into one flat list, a variable is its number and a set -setid
+	vector<int> statementstart(1, 0), statementnodes;
+	vector<unsigned int> positions;
+	vector<STATEMENT_KIND> kinds;
+	int maxvar = 0, maxset = 0;
+	for(unsigned int position=0; position<statements.size(); position=statements.next(position)){
+		positions.push_back(position);
+		STATEMENT type = statements.getType(position);
+		const int* variables = statements.getVars(position);
+		unsigned int nbvars = statements.getNbVars(position);
+		const int* constants = statements.getConstants(position);
+
+		STATEMENT_KIND kind = STATEMENT_NORMAL;
+		if(type==ECNF_MNMLIST){
+			kind = STATEMENT_MINIMIZE;
+		}else if((type==ECNF_CLAUSE && nbvars==1) || (type==ECNF_INTVAR && constants[0]==constants[1])){
+			kind = STATEMENT_FIXED;
+		}else if(type==ECNF_INTVAR || type==ECNF_INTVARDOM){
+			kind = STATEMENT_DECLARATION;
+		}
+		kinds.push_back(kind);
+		for(const int* i=variables; i<variables+nbvars; ++i){
+			statementnodes.push_back(abs(*i));
+			maxvar = max(maxvar, abs(*i));
+		}
+		int setid = 0;
+		if(type==ECNF_SET){
+			setid = constants[0];
+		}else if(type==ECNF_AGGREGATE){
+			setid = constants[1];
+		}
+		if(setid>0){
+			statementnodes.push_back(-setid);
+			maxset = max(maxset, setid);
+		}
+		statementstart.push_back(statementnodes.size());
+	}
+	int nbstatements = kinds.size();
+	for(vector<int>::iterator i=statementnodes.begin(); i<statementnodes.end(); ++i){
+		if(*i<0){
+			*i = maxvar-*i;
+		}
+	}
+
+	vector<bool> fixed(maxvar+1, false), used(maxvar+maxset+1, false);
+	for(int s=0; s<nbstatements; ++s){
+		if(kinds[s]==STATEMENT_FIXED){
+			fixed[statementnodes[statementstart[s]]] = true;
+		}
+	}
+
+	// Declarations join nothing, so an integer that no constraint uses does not become a component of its own
+	vector<int> parents(maxvar+maxset+1);
+	for(unsigned int i=0; i<parents.size(); ++i){
+		parents[i] = i;
+	}
+	for(int s=0; s<nbstatements; ++s){
+		if(kinds[s]!=STATEMENT_NORMAL && kinds[s]!=STATEMENT_MINIMIZE){
+			continue;
+		}
+		int first = -1;
+		for(int i=statementstart[s]; i<statementstart[s+1]; ++i){
+			int node = statementnodes[i];
+			if(node<=maxvar && fixed[node]){
+				continue;
+			}
+			used[node] = true;
+			if(first<0){
+				first = findRoot(parents, node);
+			}else{
+				parents[findRoot(parents, node)] = first;
+			}
+		}
+	}
+
+	// Components are numbered in the order of their first statement, statements over fixed variables only go to the first
+	// and a declaration goes with its variable
+	vector<int> components(parents.size(), -1), statementcomponent(nbstatements, 0);
+	map<int, vector<int> > users;	// Fixed variable to the components that use it
+	int nbcomponents = 0;
+	for(int s=0; s<nbstatements; ++s){
+		if(kinds[s]==STATEMENT_FIXED || (kinds[s]==STATEMENT_DECLARATION && !used[statementnodes[statementstart[s]]])){
+			continue;
+		}
+		int component = -1;
+		for(int i=statementstart[s]; i<statementstart[s+1] && component<0; ++i){
+			int node = statementnodes[i];
+			if(node>maxvar || !fixed[node]){
+				int& root = components[findRoot(parents, node)];
+				if(root<0){
+					root = nbcomponents++;
+				}
+				component = root;
+			}
+		}
+		statementcomponent[s] = max(component, 0);
+		for(int i=statementstart[s]; i<statementstart[s+1]; ++i){
+			int node = statementnodes[i];
+			if(node<=maxvar && fixed[node]){
+				users[node].push_back(statementcomponent[s]);
+			}
+		}
+	}
+	nbcomponents = max(nbcomponents, 1);
+
+	// A declaration that no constraint uses goes to the first component
+	vector<long long> nbvars(nbcomponents, 0);
+	for(int s=0; s<nbstatements; ++s){
+		if(kinds[s]==STATEMENT_DECLARATION && !used[statementnodes[statementstart[s]]]){
+			statementcomponent[s] = 0;
+			nbvars[0]++;
+		}
+	}
+	for(int v=1; v<=maxvar; ++v){
+		if(used[v]){
+			nbvars[components[findRoot(parents, v)]]++;
+		}
+	}
+	// A fixed variable used nowhere is kept in the first component
+	for(int v=1; v<=maxvar; ++v){
+		if(!fixed[v]){
+			continue;
+		}
+		vector<int>& targets = users[v];
+		if(targets.empty()){
+			targets.push_back(0);
+		}
+		sort(targets.begin(), targets.end());
+		targets.erase(unique(targets.begin(), targets.end()), targets.end());
+		for(vector<int>::const_iterator c=targets.begin(); c<targets.end(); ++c){
+			nbvars[*c]++;
+		}
+	}
+
+	vector<vector<unsigned int> > members(nbcomponents);	// The positions of the statements of each component
+	vector<bool> minimize(nbcomponents, false);
+	for(int s=0; s<nbstatements; ++s){
+		if(kinds[s]!=STATEMENT_FIXED){
+			members[statementcomponent[s]].push_back(positions[s]);
+			if(kinds[s]==STATEMENT_MINIMIZE){
+				minimize[statementcomponent[s]] = true;
+			}
+			continue;
+		}
+		const vector<int>& targets = users[statementnodes[statementstart[s]]];
+		for(vector<int>::const_iterator c=targets.begin(); c<targets.end(); ++c){
+			members[*c].push_back(positions[s]);
+		}
+	}
+
+	stringstream manifest;
+	for(int c=0; c<nbcomponents; ++c){
+		stringstream name;
+		name <<prefix <<"-" <<c+1 <<".ecnf";
+		ofstream out(name.str().c_str(), ios::out | ios::binary);
+		TextSink sink(out);
+		sink.start();
+		for(vector<unsigned int>::const_iterator i=members[c].begin(); i<members[c].end(); ++i){
+			statements.replay(sink, *i);
+		}
+		sink.finish();
+		if(!out){
+			throw fzexception("Could not write " +name.str() +".\n");
+		}
+		manifest <<name.str() <<" " <<nbvars[c] <<" " <<members[c].size() <<" " <<(minimize[c]?"minimize":"satisfy") <<"\n";
+	}
+	ofstream out((prefix+".manifest").c_str(), ios::out | ios::binary);
+	out <<manifest.str();
+	if(!out){
+		throw fzexception("Could not write " +prefix +".manifest.\n");
+	}
+	return nbcomponents;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef COMPONENTS_HPP_
+#define COMPONENTS_HPP_
+
+#include <string>
+
+namespace FZ{
+
+class StatementBuffer;
+
+/**
+ * Splits an ECNF theory into the connected components of its variables, which can be solved independently.
+ * Statements are joined by their variables and a Card or Sum by its set. Variables fixed by a unit clause or an INTVAR
+ * of one value join nothing, their statement is copied into each component that uses them. The Mnmlist joins all its
+ * literals, so the objective stays in one component. An integer declaration goes with its variable, or to the first
+ * component if no constraint uses it. The variables keep their numbers in every file.
+ * Writes PREFIX-N.ecnf per component and PREFIX.manifest, with per line the file, its number of variables and statements,
+ * and satisfy or minimize. Returns the number of components.
+ */
+int splitComponents(const StatementBuffer& statements, const std::string& prefix);
+
+}
+
+#endif /* COMPONENTS_HPP_ */
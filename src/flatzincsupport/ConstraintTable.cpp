@@ -0,0 +1,187 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/ConstraintTable.hpp"
+
+#include <sstream>
+
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+// IMPORTANT: in the same order as CONSTRAINT_TYPE
+constexpr ConstraintSignature signatures[] = {
+	{bool2int, "bool2int", 2, {ARG_BOOL, ARG_INT}, false},
+
+	{booland, "bool_and", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+	{boolclause, "bool_clause", 2, {ARG_ARRAY_OF_BOOL, ARG_ARRAY_OF_BOOL}, false},
+	{booleq, "bool_eq", 2, {ARG_BOOL, ARG_BOOL}, false},
+	{booleqr, "bool_eq_reif", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+	{boolle, "bool_le", 2, {ARG_BOOL, ARG_BOOL}, false},
+	{booller, "bool_le_reif", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+	{boollt, "bool_lt", 2, {ARG_BOOL, ARG_BOOL}, false},
+	{boolltr, "bool_lt_reif", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+	{boolnot, "bool_not", 2, {ARG_BOOL, ARG_BOOL}, false},
+	{boolor, "bool_or", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+	{boolxor, "bool_xor", 3, {ARG_BOOL, ARG_BOOL, ARG_BOOL}, false},
+
+	{intabs, "int_abs", 2, {ARG_INT, ARG_INT}, true},
+	{intdiv, "int_div", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{inteq, "int_eq", 2, {ARG_INT, ARG_INT}, false},
+	{inteqr, "int_eq_reif", 3, {ARG_INT, ARG_INT, ARG_BOOL}, false},
+	{intle, "int_le", 2, {ARG_INT, ARG_INT}, false},
+	{intler, "int_le_reif", 3, {ARG_INT, ARG_INT, ARG_BOOL}, false},
+	{intlt, "int_lt", 2, {ARG_INT, ARG_INT}, false},
+	{intltr, "int_lt_reif", 3, {ARG_INT, ARG_INT, ARG_BOOL}, false},
+	{intmax, "int_max", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{intmin, "int_min", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{intmod, "int_mod", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{intne, "int_ne", 2, {ARG_INT, ARG_INT}, false},
+	{intner, "int_ne_reif", 3, {ARG_INT, ARG_INT, ARG_BOOL}, false},
+	{intplus, "int_plus", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{inttimes, "int_times", 3, {ARG_INT, ARG_INT, ARG_INT}, true},
+	{intlineq, "int_lin_eq", 3, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT}, false},
+	{intlineqr, "int_lin_eq_reif", 4, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT, ARG_BOOL}, false},
+	{intlinle, "int_lin_le", 3, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT}, false},
+	{intlinler, "int_lin_le_reif", 4, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT, ARG_BOOL}, false},
+	{intlinne, "int_lin_ne", 3, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT}, false},
+	{intlinner, "int_lin_ne_reif", 4, {ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_INT, ARG_PAR_INT, ARG_BOOL}, false},
+
+	{arraybooland, "array_bool_and", 2, {ARG_ARRAY_OF_BOOL, ARG_BOOL}, false},
+	{arrayboolor, "array_bool_or", 2, {ARG_ARRAY_OF_BOOL, ARG_BOOL}, false},
+
+	{tableint, "table_int", 2, {ARG_ARRAY_OF_INT, ARG_ARRAY_OF_PAR_INT}, false},
+	{tablebool, "table_bool", 2, {ARG_ARRAY_OF_BOOL, ARG_ARRAY_OF_PAR_BOOL}, false},
+
+	{setcard, "set_card", 2, {ARG_SET, ARG_INT}, false},
+	{setdiff, "set_diff", 3, {ARG_SET, ARG_SET, ARG_SET}, false},
+	{seteq, "set_eq", 2, {ARG_SET, ARG_SET}, false},
+	{seteqr, "set_eq_reif", 3, {ARG_SET, ARG_SET, ARG_BOOL}, false},
+	{setin, "set_in", 2, {ARG_INT, ARG_SET}, false},
+	{setinr, "set_in_reif", 3, {ARG_INT, ARG_SET, ARG_BOOL}, false},
+	{setintersect, "set_intersect", 3, {ARG_SET, ARG_SET, ARG_SET}, false},
+	{setne, "set_ne", 2, {ARG_SET, ARG_SET}, false},
+	{setner, "set_ne_reif", 3, {ARG_SET, ARG_SET, ARG_BOOL}, false},
+	{setsubset, "set_subset", 2, {ARG_SET, ARG_SET}, false},
+	{setsubsetr, "set_subset_reif", 3, {ARG_SET, ARG_SET, ARG_BOOL}, false},
+	{setsymdiff, "set_symdiff", 3, {ARG_SET, ARG_SET, ARG_SET}, false},
+	{setunion, "set_union", 3, {ARG_SET, ARG_SET, ARG_SET}, false}
+};
+
+const unsigned int nbsignatures = sizeof(signatures)/sizeof(signatures[0]);
+
+constexpr bool inOrder(unsigned int index){
+	return index==nbsignatures || (signatures[index].type==(CONSTRAINT_TYPE)index && inOrder(index+1));
+}
+static_assert(inOrder(0), "The constraint signatures are not in the order of CONSTRAINT_TYPE.");
+
+constexpr unsigned int hashOf(CONSTRAINT_TYPE type){
+	return hashName(signatures[type].name);
+}
+
+const ConstraintSignature& FZ::getSignature(CONSTRAINT_TYPE type){
+	return signatures[type];
+}
+
+int FZ::getNbConstraintTypes(){
+	return nbsignatures;
+}
+
+/**
+ * The case labels are the compile-time hashes of all constraint names, so the compiler rejects any collision
+ * and the hash is perfect for the known names. One comparison filters out unknown names with the same hash.
+ */
+int FZ::findConstraint(const string& name){
+	int type = -1;
+	switch(hashName(name.c_str())){
+	case hashOf(bool2int): type = bool2int; break;
+	case hashOf(booland): type = booland; break;
+	case hashOf(boolclause): type = boolclause; break;
+	case hashOf(booleq): type = booleq; break;
+	case hashOf(booleqr): type = booleqr; break;
+	case hashOf(boolle): type = boolle; break;
+	case hashOf(booller): type = booller; break;
+	case hashOf(boollt): type = boollt; break;
+	case hashOf(boolltr): type = boolltr; break;
+	case hashOf(boolnot): type = boolnot; break;
+	case hashOf(boolor): type = boolor; break;
+	case hashOf(boolxor): type = boolxor; break;
+	case hashOf(intabs): type = intabs; break;
+	case hashOf(intdiv): type = intdiv; break;
+	case hashOf(inteq): type = inteq; break;
+	case hashOf(inteqr): type = inteqr; break;
+	case hashOf(intle): type = intle; break;
+	case hashOf(intler): type = intler; break;
+	case hashOf(intlt): type = intlt; break;
+	case hashOf(intltr): type = intltr; break;
+	case hashOf(intmax): type = intmax; break;
+	case hashOf(intmin): type = intmin; break;
+	case hashOf(intmod): type = intmod; break;
+	case hashOf(intne): type = intne; break;
+	case hashOf(intner): type = intner; break;
+	case hashOf(intplus): type = intplus; break;
+	case hashOf(inttimes): type = inttimes; break;
+	case hashOf(intlineq): type = intlineq; break;
+	case hashOf(intlineqr): type = intlineqr; break;
+	case hashOf(intlinle): type = intlinle; break;
+	case hashOf(intlinler): type = intlinler; break;
+	case hashOf(intlinne): type = intlinne; break;
+	case hashOf(intlinner): type = intlinner; break;
+	case hashOf(arraybooland): type = arraybooland; break;
+	case hashOf(arrayboolor): type = arrayboolor; break;
+	case hashOf(tableint): type = tableint; break;
+	case hashOf(tablebool): type = tablebool; break;
+	case hashOf(setcard): type = setcard; break;
+	case hashOf(setdiff): type = setdiff; break;
+	case hashOf(seteq): type = seteq; break;
+	case hashOf(seteqr): type = seteqr; break;
+	case hashOf(setin): type = setin; break;
+	case hashOf(setinr): type = setinr; break;
+	case hashOf(setintersect): type = setintersect; break;
+	case hashOf(setne): type = setne; break;
+	case hashOf(setner): type = setner; break;
+	case hashOf(setsubset): type = setsubset; break;
+	case hashOf(setsubsetr): type = setsubsetr; break;
+	case hashOf(setsymdiff): type = setsymdiff; break;
+	case hashOf(setunion): type = setunion; break;
+	default: return -1;
+	}
+	if(name.compare(signatures[type].name)!=0){
+		return -1;
+	}
+	return type;
+}
+
+bool fits(ARG_TYPE param, int arg){
+	if(arg==param){
+		return true;
+	}
+	return (param==ARG_INT && arg==ARG_PAR_INT) || (param==ARG_ARRAY_OF_INT && arg==ARG_ARRAY_OF_PAR_INT)
+			|| (param==ARG_ARRAY_OF_BOOL && arg==ARG_ARRAY_OF_PAR_BOOL);
+}
+
+void FZ::checkPredicate(const string& name, const vector<int>& args){
+	int type = findConstraint(name);
+	if(type<0 || signatures[type].unsupported){
+		throw fzexception("Parsing error: predicate " +name +" is declared, but it is not a supported constraint.\n");
+	}
+	const ConstraintSignature& signature = signatures[type];
+	if((int)args.size()!=signature.nbargs){
+		stringstream ss;
+		ss <<"Parsing error: predicate " <<name <<" is declared with " <<args.size() <<" arguments, the constraint has " <<signature.nbargs <<".\n";
+		throw fzexception(ss.str());
+	}
+	for(int i=0; i<signature.nbargs; ++i){
+		if(!fits(signature.args[i], args[i])){
+			stringstream ss;
+			ss <<"Parsing error: argument " <<i+1 <<" of predicate " <<name <<" does not have the type of the constraint.\n";
+			throw fzexception(ss.str());
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef CONSTRAINTTABLE_HPP_
+#define CONSTRAINTTABLE_HPP_
+
+#include <string>
+#include <vector>
+
+namespace FZ{
+
+enum CONSTRAINT_TYPE {
+	bool2int,
+
+	booland, boolclause, booleq, booleqr, boolle, booller, boollt, boolltr, boolnot, boolor, boolxor,
+
+	intabs, intdiv, inteq, inteqr, intle, intler, intlt, intltr, intmax, intmin, intmod, intne, intner, intplus, inttimes,
+	intlineq, intlineqr, intlinle, intlinler, intlinne, intlinner,
+
+	arraybooland, arrayboolor,
+
+	tableint, tablebool,
+
+	setcard, setdiff, seteq, seteqr, setin, setinr, setintersect, setne, setner, setsubset, setsubsetr, setsymdiff, setunion
+};
+
+enum ARG_TYPE { ARG_BOOL, ARG_INT, ARG_PAR_INT, ARG_SET, ARG_ARRAY_OF_SET, ARG_ARRAY_OF_INT, ARG_ARRAY_OF_PAR_INT, ARG_ARRAY_OF_BOOL, ARG_ARRAY_OF_PAR_BOOL };
+
+const int MAXCONSTRAINTARGS = 4;
+
+/**
+ * The flatzinc name of a constraint and the types of its arguments.
+ * Only the scalar arguments are parsed generically, arrays and sets are left to the constraint handler.
+ * An unsupported constraint is known by name, but the translator has no handler for it.
+ */
+struct ConstraintSignature{
+	CONSTRAINT_TYPE type;
+	const char* name;
+	int nbargs;
+	ARG_TYPE args[MAXCONSTRAINTARGS];
+	bool unsupported;
+};
+
+// FNV-1a, evaluated at compile time for the names in the constraint table
+constexpr unsigned int hashName(const char* name, unsigned int hash = 2166136261u){
+	return *name=='\0'?hash:hashName(name+1, (hash ^ (unsigned char)*name) * 16777619u);
+}
+
+const ConstraintSignature& getSignature(CONSTRAINT_TYPE type);
+int getNbConstraintTypes();
+
+// Returns -1 if the name is not a known constraint
+int findConstraint(const std::string& name);
+
+/**
+ * Checks a predicate declaration of the model, which the solver library (mznlib) makes for each global it supports natively.
+ * The arguments are ARG_TYPEs, -1 for a type without one. Par arguments also fit var arguments of the constraint.
+ * Throws if the predicate is not a supported constraint or its arguments do not fit the signature.
+ */
+void checkPredicate(const std::string& name, const std::vector<int>& args);
+
+}
+
+#endif /* CONSTRAINTTABLE_HPP_ */
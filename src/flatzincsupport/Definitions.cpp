@@ -0,0 +1,82 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/Definitions.hpp"
+
+#include <map>
+#include <algorithm>
+
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+// Tarjan's strongly connected components, with an explicit stack as definitions can be long chains
+void FZ::getRecursiveRules(const vector<Rule>& rules, vector<bool>& recursive){
+	int size = rules.size();
+	map<int, int> rulefor;
+	for(int r=0; r<size; ++r){
+		if(!rulefor.insert(pair<int, int>(rules[r].head, r)).second){
+			throw fzexception("Multiple rules for the same head.\n");
+		}
+	}
+	vector<vector<int> > dependencies(size);
+	for(int r=0; r<size; ++r){
+		for(vector<int>::const_iterator i=rules[r].body.begin(); i<rules[r].body.end(); ++i){
+			map<int, int>::const_iterator dependency = rulefor.find(*i<0?-*i:*i);
+			if(dependency!=rulefor.end()){
+				dependencies[r].push_back((*dependency).second);
+			}
+		}
+	}
+
+	recursive.assign(size, false);
+	vector<int> index(size, -1), lowlink(size, 0), component;
+	vector<bool> oncomponent(size, false);
+	vector<pair<int, unsigned int> > calls; // A rule and its next dependency
+	int counter = 0;
+	for(int root=0; root<size; ++root){
+		if(index[root]!=-1){
+			continue;
+		}
+		index[root] = lowlink[root] = counter++;
+		component.push_back(root);
+		oncomponent[root] = true;
+		calls.push_back(pair<int, unsigned int>(root, 0));
+		while(calls.size()>0){
+			int r = calls.back().first;
+			if(calls.back().second<dependencies[r].size()){
+				int d = dependencies[r][calls.back().second++];
+				if(index[d]==-1){
+					index[d] = lowlink[d] = counter++;
+					component.push_back(d);
+					oncomponent[d] = true;
+					calls.push_back(pair<int, unsigned int>(d, 0));
+				}else if(oncomponent[d]){
+					lowlink[r] = min(lowlink[r], index[d]);
+				}
+				continue;
+			}
+			calls.pop_back();
+			if(calls.size()>0){
+				lowlink[calls.back().first] = min(lowlink[calls.back().first], lowlink[r]);
+			}
+			if(lowlink[r]!=index[r]){
+				continue;
+			}
+			bool cyclic = component.back()!=r || find(dependencies[r].begin(), dependencies[r].end(), r)!=dependencies[r].end();
+			int member;
+			do{
+				member = component.back();
+				component.pop_back();
+				oncomponent[member] = false;
+				recursive[member] = cyclic;
+			}while(member!=r);
+		}
+	}
+}
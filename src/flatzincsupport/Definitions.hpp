@@ -0,0 +1,33 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef DEFINITIONS_HPP_
+#define DEFINITIONS_HPP_
+
+#include <vector>
+
+namespace FZ{
+
+// The rule head <- body of an inductive definition, the body is a conjunction if conj, a disjunction otherwise
+struct Rule{
+	int head;
+	std::vector<int> body;
+	bool conj;
+};
+
+/**
+ * Marks the rules whose head is in a cycle of the dependency graph of the definition, so depends on itself
+ * through the bodies. Only those need the well-founded semantics, the others are equivalent to their completion.
+ * Negative body literals are dependencies too: p <- ~q, q <- ~p has no two-valued well-founded model.
+ * Every head has at most one rule.
+ */
+void getRecursiveRules(const std::vector<Rule>& rules, std::vector<bool>& recursive);
+
+}
+
+#endif /* DEFINITIONS_HPP_ */
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/EcnfScanner.hpp"
+
+#include <cstring>
+
+#include "flatzincsupport/fzexception.hpp"
+#include "flatzincsupport/EcnfSink.hpp"
+
+using namespace std;
+using namespace FZ;
+
+bool StatementScanner::isToken(unsigned int index, const char* value) const{
+	if(index>=tokens.size()){
+		return false;
+	}
+	string::size_type length = tokens[index].second-tokens[index].first;
+	return length==strlen(value) && text.compare(tokens[index].first, length, value)==0;
+}
+
+int StatementScanner::getInt(unsigned int index) const{
+	if(index>=tokens.size()){
+		throw fzexception("Incomplete statement in the output.\n");
+	}
+	string::size_type i = tokens[index].first;
+	bool negative = text[i]=='-';
+	int value = 0;
+	for(i += negative?1:0; i<tokens[index].second && text[i]!='='; ++i){
+		value = value*10+(text[i]-'0');
+	}
+	return negative?-value:value;
+}
+
+int StatementScanner::getWeight(unsigned int index) const{
+	if(index>=tokens.size()){
+		throw fzexception("Incomplete statement in the output.\n");
+	}
+	string::size_type i = text.find('=', tokens[index].first);
+	if(i==string::npos || i>=tokens[index].second){
+		throw fzexception("Expected a weight in the output.\n");
+	}
+	bool negative = text[i+1]=='-';
+	int value = 0;
+	for(i += negative?2:1; i<tokens[index].second; ++i){
+		value = value*10+(text[i]-'0');
+	}
+	return negative?-value:value;
+}
+
+void StatementScanner::addVariable(unsigned int index, vector<VariableToken>& variables) const{
+	if(index>=tokens.size()){
+		throw fzexception("Incomplete statement in the output.\n");
+	}
+	VariableToken variable;
+	variable.begin = tokens[index].first;
+	bool negative = text[variable.begin]=='-';
+	int lit = 0;
+	string::size_type i = variable.begin+(negative?1:0);
+	for(; i<tokens[index].second && text[i]!='='; ++i){
+		lit = lit*10+(text[i]-'0');
+	}
+	variable.end = i;
+	variable.lit = negative?-lit:lit;
+	variables.push_back(variable);
+}
+
+/**
+ * Clauses and Mnmlist consist of literals, Equiv of a head and a body, possibly separated by |,
+ * rules (C | defid head body) and SUMSTSIRI (head vars | weights op bound) also contain constants.
+ * Set and WSet (setid lit=weight ...) list the literals of a set, Card and Sum (C head setid L|G bound) only have a head.
+ * Comment (c) and header (p) lines are statements without variables.
+ */
+bool StatementScanner::next(vector<VariableToken>& variables){
+	variables.clear();
+	if(position>=text.size()){
+		return false;
+	}
+	string::size_type end = text.find('\n', position);
+	if(end==string::npos){
+		end = text.size();
+	}
+	tokens.clear();
+	for(string::size_type i=position; i<end;){
+		if(text[i]==' '){
+			++i;
+			continue;
+		}
+		string::size_type start = i;
+		while(i<end && text[i]!=' '){
+			++i;
+		}
+		tokens.push_back(pair<string::size_type, string::size_type>(start, i));
+	}
+	position = end+1;
+	if(tokens.size()==0){
+		return true;
+	}
+
+	// Comment and header lines have no variables
+	if(isToken(0, "c") || isToken(0, "p")){
+		return true;
+	}
+
+	// Every statement ends with 0
+	unsigned int last = tokens.size()-1;
+	char first = text[tokens[0].first];
+	if(first=='-' || (first>='0' && first<='9')){
+		for(unsigned int i=0; i<last; ++i){
+			addVariable(i, variables);
+		}
+	}else if(isToken(0, "Equiv")){
+		for(unsigned int i=2; i<last; ++i){
+			if(!isToken(i, "|")){
+				addVariable(i, variables);
+			}
+		}
+	}else if((isToken(0, "C") || isToken(0, "D")) && isToken(1, "|")){
+		for(unsigned int i=3; i<last; ++i){
+			addVariable(i, variables);
+		}
+	}else if(isToken(0, "Set") || isToken(0, "WSet")){
+		for(unsigned int i=2; i<last; ++i){
+			addVariable(i, variables);
+		}
+	}else if(isToken(0, "Card") || isToken(0, "Sum")){
+		addVariable(2, variables);
+	}else if(isToken(0, "Mnmlist")){
+		for(unsigned int i=1; i<last; ++i){
+			addVariable(i, variables);
+		}
+	}else if(isToken(0, "INTVAR") || isToken(0, "INTVARDOM")){
+		addVariable(1, variables);
+	}else if(isToken(0, "BINTRI")){
+		addVariable(1, variables);
+		addVariable(2, variables);
+	}else if(isToken(0, "BINTRT")){
+		addVariable(1, variables);
+		addVariable(2, variables);
+		addVariable(4, variables);
+	}else if(isToken(0, "SUMSTSIRI")){
+		for(unsigned int i=1; i<last && !isToken(i, "|"); ++i){
+			addVariable(i, variables);
+		}
+	}else{
+		throw fzexception("Unknown statement in the output.\n");
+	}
+	return true;
+}
+
+// In the order of COMPARISON, with TextSink
+extern const char* comparisons[];
+
+COMPARISON getComparison(const StatementScanner& scanner, unsigned int index){
+	for(int op=COMP_EQ; op<=COMP_GE; ++op){
+		if(scanner.isToken(index, comparisons[op])){
+			return (COMPARISON)op;
+		}
+	}
+	throw fzexception("Unknown comparison in the output.\n");
+}
+
+void FZ::parseStatements(const string& text, EcnfSink& sink){
+	StatementScanner scanner(text);
+	vector<VariableToken> variables;
+	vector<int> first, second;
+	while(scanner.next(variables)){
+		if(scanner.getNbTokens()==0 || scanner.isToken(0, "c") || scanner.isToken(0, "p")){
+			continue;
+		}
+		// Every statement ends with 0
+		unsigned int last = scanner.getNbTokens()-1;
+		first.clear();
+		second.clear();
+		if(scanner.isToken(0, "Equiv")){
+			for(vector<VariableToken>::const_iterator i=variables.begin()+1; i<variables.end(); ++i){
+				first.push_back((*i).lit);
+			}
+			sink.addEquivalence(variables[0].lit, scanner.isToken(1, "C"), first);
+		}else if(scanner.isToken(1, "|") && (scanner.isToken(0, "C") || scanner.isToken(0, "D"))){
+			for(vector<VariableToken>::const_iterator i=variables.begin()+1; i<variables.end(); ++i){
+				first.push_back((*i).lit);
+			}
+			sink.addRule(scanner.getInt(2), variables[0].lit, scanner.isToken(0, "C"), first);
+		}else if(scanner.isToken(0, "Set") || scanner.isToken(0, "WSet")){
+			bool weighted = scanner.isToken(0, "WSet");
+			for(unsigned int i=2; i<last; ++i){
+				first.push_back(variables[i-2].lit);
+				if(weighted){
+					second.push_back(scanner.getWeight(i));
+				}
+			}
+			sink.addSet(scanner.getInt(1), first, second);
+		}else if(scanner.isToken(0, "Card") || scanner.isToken(0, "Sum")){
+			sink.addAggregate(scanner.isToken(0, "Card")?AGG_CARD:AGG_SUM, variables[0].lit, scanner.getInt(3), scanner.isToken(4, "L"), scanner.getInt(5));
+		}else if(scanner.isToken(0, "Mnmlist")){
+			for(vector<VariableToken>::const_iterator i=variables.begin(); i<variables.end(); ++i){
+				first.push_back((*i).lit);
+			}
+			sink.addMinimize(first);
+		}else if(scanner.isToken(0, "INTVAR")){
+			sink.addIntVar(variables[0].lit, scanner.getInt(2), scanner.getInt(3));
+		}else if(scanner.isToken(0, "INTVARDOM")){
+			for(unsigned int i=2; i<last; ++i){
+				first.push_back(scanner.getInt(i));
+			}
+			sink.addIntVar(variables[0].lit, first);
+		}else if(scanner.isToken(0, "BINTRI")){
+			sink.addComparison(variables[0].lit, variables[1].lit, getComparison(scanner, 3), scanner.getInt(4));
+		}else if(scanner.isToken(0, "BINTRT")){
+			sink.addVarComparison(variables[0].lit, variables[1].lit, getComparison(scanner, 3), variables[2].lit);
+		}else if(scanner.isToken(0, "SUMSTSIRI")){
+			for(vector<VariableToken>::const_iterator i=variables.begin()+1; i<variables.end(); ++i){
+				first.push_back((*i).lit);
+			}
+			// head vars | weights op bound 0
+			for(unsigned int i=variables.size()+2; i+2<last; ++i){
+				second.push_back(scanner.getInt(i));
+			}
+			sink.addLinear(variables[0].lit, first, second, getComparison(scanner, last-2), scanner.getInt(last-1));
+		}else{
+			for(vector<VariableToken>::const_iterator i=variables.begin(); i<variables.end(); ++i){
+				first.push_back((*i).lit);
+			}
+			sink.addClause(first);
+		}
+	}
+}
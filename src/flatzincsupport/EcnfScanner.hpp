@@ -0,0 +1,56 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef ECNFSCANNER_HPP_
+#define ECNFSCANNER_HPP_
+
+#include <string>
+#include <vector>
+
+namespace FZ{
+
+// The position of a variable in the text, lit is negative if the variable is negated
+// In a weighted set, only the literal before the = is the variable
+struct VariableToken{
+	std::string::size_type begin, end;
+	int lit;
+};
+
+/**
+ * Finds the variables in ECNF statements, which are one per line.
+ * Used to read the text TextSink wrote back, every new kind of statement has to be known here.
+ */
+class StatementScanner{
+private:
+	const std::string& text;
+	std::string::size_type position;
+	std::vector<std::pair<std::string::size_type, std::string::size_type> > tokens;
+
+	void addVariable(unsigned int index, std::vector<VariableToken>& variables) const;
+
+public:
+	StatementScanner(const std::string& text): text(text), position(0){}
+
+	// Replaces variables by those of the next statement, returns false if there is none
+	bool next(std::vector<VariableToken>& variables);
+
+	// The tokens of the last statement
+	unsigned int getNbTokens() const { return tokens.size(); }
+	bool isToken(unsigned int index, const char* value) const;
+	int getInt(unsigned int index) const;
+	int getWeight(unsigned int index) const;	// The part after the = of lit=weight
+};
+
+class EcnfSink;
+
+// Passes the statements of ECNF text on to the typed methods of sink, header and comment lines are skipped
+void parseStatements(const std::string& text, EcnfSink& sink);
+
+}
+
+#endif /* ECNFSCANNER_HPP_ */
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/EcnfSink.hpp"
+
+using namespace std;
+using namespace FZ;
+
+const char* comparisons[] = { "=", "~=", "<", "=<", ">", ">=" };
+
+void TextSink::writeList(Span<int> elements){
+	for(const int* i=elements.begin(); i<elements.end(); ++i){
+		out <<*i <<" ";
+	}
+}
+
+void TextSink::start(){
+	out <<"c Automated transformation from a flatzinc model into ECNF.\n";
+	out <<"p ecnf\n";
+}
+
+void TextSink::addClause(Span<int> lits){
+	writeList(lits);
+	out <<"0\n";
+}
+
+void TextSink::addEquivalence(int head, bool conj, Span<int> body){
+	out <<"Equiv " <<(conj?"C":"D") <<" " <<head <<" ";
+	writeList(body);
+	out <<"0\n";
+}
+
+void TextSink::addRule(int definition, int head, bool conj, Span<int> body){
+	out <<(conj?"C":"D") <<" | " <<definition <<" " <<head <<" ";
+	writeList(body);
+	out <<"0\n";
+}
+
+void TextSink::addIntVar(int var, int lower, int upper){
+	out <<"INTVAR " <<var <<" " <<lower <<" " <<upper <<" 0\n";
+}
+
+void TextSink::addIntVar(int var, Span<int> domain){
+	out <<"INTVARDOM " <<var <<" ";
+	writeList(domain);
+	out <<"0\n";
+}
+
+void TextSink::addComparison(int head, int var, COMPARISON op, int value){
+	out <<"BINTRI " <<head <<" " <<var <<" " <<comparisons[op] <<" " <<value <<" 0\n";
+}
+
+void TextSink::addVarComparison(int head, int var, COMPARISON op, int var2){
+	out <<"BINTRT " <<head <<" " <<var <<" " <<comparisons[op] <<" " <<var2 <<" 0\n";
+}
+
+void TextSink::addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound){
+	out <<"SUMSTSIRI " <<head <<" ";
+	writeList(vars);
+	out <<"| ";
+	writeList(weights);
+	out <<comparisons[op] <<" " <<bound <<" 0\n";
+}
+
+void TextSink::addSet(int setid, Span<int> lits, Span<int> weights){
+	out <<(weights.size()==0?"Set ":"WSet ") <<setid <<" ";
+	for(unsigned int i=0; i<lits.size(); ++i){
+		out <<lits[i];
+		if(weights.size()!=0){
+			out <<"=" <<weights[i];
+		}
+		out <<" ";
+	}
+	out <<"0\n";
+}
+
+void TextSink::addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound){
+	out <<(type==AGG_CARD?"Card":"Sum") <<" C " <<head <<" " <<setid <<" " <<(upper?"L":"G") <<" " <<bound <<" 0\n";
+}
+
+void TextSink::addMinimize(Span<int> lits){
+	out <<"Mnmlist ";
+	writeList(lits);
+	out <<"0\n";
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef ECNFSINK_HPP_
+#define ECNFSINK_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace FZ{
+
+// A view on consecutive elements owned by someone else, only valid during the call it is passed to
+template<class T>
+class Span{
+private:
+	const T* first;
+	unsigned int length;
+
+public:
+	Span(): first(NULL), length(0){}
+	Span(const T* first, unsigned int length): first(first), length(length){}
+	Span(const std::vector<T>& elements): first(elements.size()==0?NULL:&elements[0]), length(elements.size()){}
+
+	unsigned int size() const { return length; }
+	const T* begin() const { return first; }
+	const T* end() const { return first+length; }
+	const T& operator[](unsigned int index) const { return first[index]; }
+};
+
+enum COMPARISON { COMP_EQ, COMP_NE, COMP_LT, COMP_LE, COMP_GT, COMP_GE };
+enum AGGREGATE { AGG_CARD, AGG_SUM };
+
+/**
+ * Receives the translated theory. Variables are numbered from 1, a negative literal is the negation of its variable.
+ * Booleans are not declared. Every constraint with a head literal holds iff its head is true.
+ * The translator calls the typed methods from its statement buffer, only TextSink formats the statements as text.
+ */
+class EcnfSink{
+public:
+	virtual ~EcnfSink(){}
+
+	virtual void start(){}
+	virtual void finish(){}
+
+	virtual void addClause(Span<int> lits) = 0;
+	// head <=> the conjunction (conj) or disjunction of the body
+	virtual void addEquivalence(int head, bool conj, Span<int> body) = 0;
+	// The rule head <- body of inductive definition definition
+	virtual void addRule(int definition, int head, bool conj, Span<int> body) = 0;
+	virtual void addIntVar(int var, int lower, int upper) = 0;
+	virtual void addIntVar(int var, Span<int> domain) = 0;
+	// head <=> var op value
+	virtual void addComparison(int head, int var, COMPARISON op, int value) = 0;
+	// head <=> var op var2
+	virtual void addVarComparison(int head, int var, COMPARISON op, int var2) = 0;
+	// head <=> sum(weights[i]*vars[i]) op bound
+	virtual void addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound) = 0;
+	// A set of literals, weights is empty for an unweighted set
+	virtual void addSet(int setid, Span<int> lits, Span<int> weights) = 0;
+	// head <=> the aggregate over the true literals of the set is at most (upper) or at least bound
+	virtual void addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound) = 0;
+	// Minimize the first literal of lits that is true
+	virtual void addMinimize(Span<int> lits) = 0;
+	// A search annotation of the model, after all statements: decide on vars in this order
+	virtual void addSearch(bool /*booleans*/, Span<int> /*vars*/, const std::string& /*varselect*/,
+			const std::string& /*valselect*/, const std::string& /*strategy*/){}
+};
+
+// Writes ECNF text
+class TextSink: public EcnfSink{
+private:
+	std::ostream& out;
+
+	void writeList(Span<int> elements);
+
+public:
+	TextSink(std::ostream& out): out(out){}
+
+	void start();
+
+	void addClause(Span<int> lits);
+	void addEquivalence(int head, bool conj, Span<int> body);
+	void addRule(int definition, int head, bool conj, Span<int> body);
+	void addIntVar(int var, int lower, int upper);
+	void addIntVar(int var, Span<int> domain);
+	void addComparison(int head, int var, COMPARISON op, int value);
+	void addVarComparison(int head, int var, COMPARISON op, int var2);
+	void addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound);
+	void addSet(int setid, Span<int> lits, Span<int> weights);
+	void addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound);
+	void addMinimize(Span<int> lits);
+};
+
+}
+
+#endif /* ECNFSINK_HPP_ */
@@ -9,8 +9,16 @@
 #include "flatzincsupport/FZDatastructs.hpp"
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <climits>
 
 #include "flatzincsupport/fzexception.hpp"
+#include "flatzincsupport/Statistics.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
+#include "flatzincsupport/VariableMap.hpp"
+#include "flatzincsupport/SearchHints.hpp"
+#include "flatzincsupport/StatementBuffer.hpp"
 
 using namespace std;
 using namespace FZ;
@@ -20,39 +28,234 @@ std::map<std::string, MBoolVar*> name2bool;
 std::map<std::string, MIntVar*> name2int;
 std::map<std::string, MBoolArrayVar*> name2boolarray;
 std::map<std::string, MIntArrayVar*> name2intarray;
+std::map<std::string, MSetVar*> name2set;
+std::map<std::string, MSetArrayVar*> name2setarray;
+
+const int wordbits = sizeof(unsigned long)*8;
+
+IntBitset::IntBitset(const vector<int>& values): offset(0){
+	if(values.size()==0){
+		return;
+	}
+	offset = *min_element(values.begin(), values.end());
+	long long span = (long long)*max_element(values.begin(), values.end())-offset+1;
+	if(span/wordbits>(long long)values.size()){
+		sorted = values;
+		sort(sorted.begin(), sorted.end());
+		sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+		return;
+	}
+	words.resize(span/wordbits+1, 0);
+	for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+		unsigned int index = (long long)*i-offset;
+		words[index/wordbits] |= 1UL<<(index%wordbits);
+	}
+}
+
+IntBitset::IntBitset(int begin, int end): offset(0){
+	if(begin<=end){
+		ranges.push_back(pair<int, int>(begin, end));
+	}
+}
+
+//The ranges are sorted and those that overlap or touch are joined
+IntBitset::IntBitset(const vector<pair<int, int> >& unsorted): offset(0){
+	vector<pair<int, int> > sortedranges(unsorted);
+	sort(sortedranges.begin(), sortedranges.end());
+	for(vector<pair<int, int> >::const_iterator i=sortedranges.begin(); i<sortedranges.end(); ++i){
+		if((*i).first>(*i).second){
+			continue;
+		}
+		if(ranges.size()>0 && (*i).first<=(long long)ranges.back().second+1){
+			ranges.back().second = max(ranges.back().second, (*i).second);
+		}else{
+			ranges.push_back(*i);
+		}
+	}
+}
+
+bool IntBitset::contains(int value) const{
+	if(ranges.size()>0){
+		vector<pair<int, int> >::const_iterator next = upper_bound(ranges.begin(), ranges.end(), pair<int, int>(value, INT_MAX));
+		return next!=ranges.begin() && value<=(*(next-1)).second;
+	}
+	if(sorted.size()>0){
+		return binary_search(sorted.begin(), sorted.end(), value);
+	}
+	if(value<offset){
+		return false;
+	}
+	unsigned int index = (long long)value-offset;
+	if(index/wordbits>=words.size()){
+		return false;
+	}
+	return (words[index/wordbits]>>(index%wordbits)) & 1UL;
+}
+
+long long IntBitset::size() const{
+	long long size = sorted.size();
+	for(vector<pair<int, int> >::const_iterator i=ranges.begin(); i<ranges.end(); ++i){
+		size += (long long)(*i).second-(*i).first+1;
+	}
+	for(vector<unsigned long>::const_iterator i=words.begin(); i<words.end(); ++i){
+		size += __builtin_popcountl(*i);
+	}
+	return size;
+}
+
+void IntBitset::getValues(vector<int>& values) const{
+	for(vector<pair<int, int> >::const_iterator i=ranges.begin(); i<ranges.end(); ++i){
+		for(long long value=(*i).first; value<=(*i).second; ++value){
+			values.push_back(value);
+		}
+	}
+	values.insert(values.end(), sorted.begin(), sorted.end());
+	for(unsigned int w=0; w<words.size(); ++w){
+		for(unsigned long word=words[w]; word!=0; word &= word-1){
+			values.push_back(offset+w*wordbits+__builtin_ctzl(word));
+		}
+	}
+}
+
+void ArrayLiteral::add(Expression* expr){
+	getExprs();
+	exprs->push_back(expr);
+}
+
+void ArrayLiteral::addInt(int value){
+	if(literals==LITERALS_NONE && exprs->size()==0){
+		delete(exprs);
+		exprs = NULL;
+		values = new vector<int>();
+		literals = LITERALS_INT;
+	}
+	if(literals!=LITERALS_INT){
+		Expression* expr = new Expression();
+		expr->type = EXPR_INT;
+		expr->intlit = value;
+		add(expr);
+		return;
+	}
+	values->push_back(value);
+}
+
+void ArrayLiteral::addBool(bool value){
+	if(literals==LITERALS_NONE && exprs->size()==0){
+		delete(exprs);
+		exprs = NULL;
+		values = new vector<int>();
+		literals = LITERALS_BOOL;
+	}
+	if(literals!=LITERALS_BOOL){
+		Expression* expr = new Expression();
+		expr->type = EXPR_BOOL;
+		expr->boollit = value;
+		add(expr);
+		return;
+	}
+	values->push_back(value?1:0);
+}
+
+const vector<Expression*>& ArrayLiteral::getExprs(){
+	if(exprs!=NULL){
+		return *exprs;
+	}
+	exprs = new vector<Expression*>();
+	exprs->reserve(values->size());
+	for(vector<int>::const_iterator i=values->begin(); i<values->end(); ++i){
+		Expression* expr = new Expression();
+		if(literals==LITERALS_INT){
+			expr->type = EXPR_INT;
+			expr->intlit = *i;
+		}else{
+			expr->type = EXPR_BOOL;
+			expr->boollit = *i!=0;
+		}
+		exprs->push_back(expr);
+	}
+	delete(values);
+	values = NULL;
+	literals = LITERALS_NONE;
+	return *exprs;
+}
 
 MBoolVar* createBoolVar(const string& name){
+	MemoryScope records(MEM_RECORDS);
 	MBoolVar* var = new MBoolVar();
 	var->var = nextint++;
 	var->hasmap = false;
 	var->hasvalue = false;
+	MemoryScope symbols(MEM_SYMBOLS);
 	name2bool.insert(pair<string, MBoolVar*>(name, var));
 	return var;
 }
 
 int FZ::createOneShotVar(){
+	getStatistics().oneshotvars++;
 	return nextint++;
 }
 
+int FZ::getMaxVar(){
+	return nextint-1;
+}
+
+//The records are not freed: arrays share them with the symbols and with each other
+void FZ::clearSymbols(){
+	nextint = 1;
+	name2bool.clear();
+	name2int.clear();
+	name2boolarray.clear();
+	name2intarray.clear();
+	name2set.clear();
+	name2setarray.clear();
+	getOutputVariables().clear();
+	getSearchHints().clear();
+}
+
 MIntVar* createIntVar(const string& name){
+	MemoryScope records(MEM_RECORDS);
 	MIntVar* var = new MIntVar();
 	var->var = nextint++;
 	var->hasmap = false;
 	var->hasvalue = false;
+	MemoryScope symbols(MEM_SYMBOLS);
 	name2int.insert(pair<string, MIntVar*>(name, var));
 	return var;
 }
 
+MSetVar* createSetVar(const string& name){
+	MemoryScope records(MEM_RECORDS);
+	MSetVar* var = new MSetVar();
+	var->hasvalue = false;
+	var->offset = 0;
+	MemoryScope symbols(MEM_SYMBOLS);
+	name2set.insert(pair<string, MSetVar*>(name, var));
+	return var;
+}
+
+MSetArrayVar* createSetArrayVar(const string& name, int nbelem){
+	MemoryScope records(MEM_RECORDS);
+	MSetArrayVar* var = new MSetArrayVar();
+	var->nbelem = nbelem;
+	MemoryScope symbols(MEM_SYMBOLS);
+	name2setarray.insert(pair<string, MSetArrayVar*>(name, var));
+	return var;
+}
+
 MBoolArrayVar* createBoolArrayVar(const string& name, int nbelem){
+	MemoryScope records(MEM_RECORDS);
 	MBoolArrayVar* var = new MBoolArrayVar();
 	var->nbelem = nbelem;
+	MemoryScope symbols(MEM_SYMBOLS);
 	name2boolarray.insert(pair<string, MBoolArrayVar*>(name, var));
 	return var;
 }
 
 MIntArrayVar* createIntArrayVar(const string& name, int nbelem){
+	MemoryScope records(MEM_RECORDS);
 	MIntArrayVar* var = new MIntArrayVar();
 	var->nbelem = nbelem;
+	MemoryScope symbols(MEM_SYMBOLS);
 	name2intarray.insert(pair<string, MIntArrayVar*>(name, var));
 	return var;
 }
@@ -90,6 +293,38 @@ MIntVar* FZ::getIntVar(const string& name, int index){
 	return (*it).second->vars[index-1];
 }
 
+MBoolArrayVar* FZ::getBoolArrayVar(const string& name){
+	map<string, MBoolArrayVar*>::iterator it = name2boolarray.find(name);
+	if(it==name2boolarray.end()){
+		throw fzexception("Array was not declared.\n");
+	}
+	return (*it).second;
+}
+
+MIntArrayVar* FZ::getIntArrayVar(const string& name){
+	map<string, MIntArrayVar*>::iterator it = name2intarray.find(name);
+	if(it==name2intarray.end()){
+		throw fzexception("Array was not declared.\n");
+	}
+	return (*it).second;
+}
+
+MSetVar* FZ::getSetVar(const string& name){
+	map<string, MSetVar*>::iterator it = name2set.find(name);
+	if(it==name2set.end()){
+		throw fzexception("Variable was not declared.\n");
+	}
+	return (*it).second;
+}
+
+MSetVar* FZ::getSetVar(const string& name, int index){
+	map<string, MSetArrayVar*>::iterator it = name2setarray.find(name);
+	if(it==name2setarray.end() || index<1 || (int)(*it).second->vars.size()<index){
+		throw fzexception("Array was not declared or not initialized.\n");
+	}
+	return (*it).second->vars[index-1];
+}
+
 int FZ::getVar(const string& name, bool expectbool){
 	if(expectbool){
 		return getBoolVar(name)->var;
@@ -106,68 +341,144 @@ int FZ::getVar(const string& name, int index, bool expectbool){
 	}
 }
 
-int FZ::getTrue(std::ostream& vars){
+int FZ::getTrue(StatementBuffer& vars){
+	getStatistics().truevars++;
 	int newvar = nextint++;
-	vars <<newvar <<" 0\n";
+	vars.addUnit(newvar);
 	return newvar;
 }
 
-int FZ::getFalse(std::ostream& vars){
+int FZ::getFalse(StatementBuffer& vars){
+	getStatistics().falsevars++;
 	int newvar = nextint++;
-	vars <<-newvar <<" 0\n";
+	vars.addUnit(-newvar);
 	return newvar;
 }
 
 
 
 
-void addBoolExpr(MBoolVar& var, const Expression& expr, std::stringstream& vars, std::stringstream& theory){
+// The names passed to findAnnotation, hasDefinitionAnnotation and InsertWrapper::addSearchAnnotation
+const char* readannotations[] = { "output_var", "output_array", "inductivelydefined", "int_search", "bool_search", "seq_search" };
+
+bool FZ::isReadAnnotation(const char* name, size_t length){
+	for(unsigned int i=0; i<sizeof(readannotations)/sizeof(readannotations[0]); ++i){
+		if(strlen(readannotations[i])==length && strncmp(readannotations[i], name, length)==0){
+			return true;
+		}
+	}
+	return false;
+}
+
+// Returns NULL if the variable is not annotated with name
+const Expression* findAnnotation(const Identifier& id, const char* name){
+	if(id.arguments==NULL){
+		return NULL;
+	}
+	for(vector<Expression*>::const_iterator i=id.arguments->begin(); i<id.arguments->end(); ++i){
+		if((*i)->type==EXPR_IDENT && (*i)->ident->name->compare(name)==0){
+			return *i;
+		}
+	}
+	return NULL;
+}
+
+MappedElement getMappedElement(const MBoolVar& var){
+	return var.hasvalue?MappedElement(MAP_BOOL_VALUE, var.mappedvalue):MappedElement(MAP_BOOL, var.var);
+}
+
+MappedElement getMappedElement(const MIntVar& var){
+	return var.hasvalue?MappedElement(MAP_INT_VALUE, var.mappedvalue):MappedElement(MAP_INT, var.var);
+}
+
+template<typename T>
+void addOutputVar(const string& name, const T& var){
+	OutputVariable output;
+	output.name = name;
+	output.elements.push_back(getMappedElement(var));
+	getOutputVariables().push_back(output);
+}
+
+template<typename T>
+void addOutputArray(const string& name, const Expression& annotation, const vector<T*>& vars){
+	OutputVariable output;
+	output.name = name;
+	const vector<Expression*>* args = annotation.ident->arguments;
+	if(args==NULL || args->size()!=1 || args->front()->type!=EXPR_ARRAY){
+		throw fzexception("Incorrect number of annotation arguments.\n");
+	}
+	const vector<Expression*>& dims = args->front()->arraylit->getExprs();
+	for(vector<Expression*>::const_iterator i=dims.begin(); i<dims.end(); ++i){
+		if((*i)->type!=EXPR_SET || !(*i)->setlit->range){
+			throw fzexception("Incorrect output_array annotation.\n");
+		}
+		output.dims.push_back(pair<int, int>((*i)->setlit->begin, (*i)->setlit->end));
+	}
+	for(typename vector<T*>::const_iterator i=vars.begin(); i<vars.end(); ++i){
+		output.elements.push_back(getMappedElement(**i));
+	}
+	getOutputVariables().push_back(output);
+}
+
+void addBoolValue(MBoolVar& var, bool value, StatementBuffer& theory){
+	var.hasvalue = true;
+	var.mappedvalue = value;
+	theory.addUnit(value?var.var:-var.var);
+}
+
+void addBoolExpr(MBoolVar& var, const Expression& expr, StatementBuffer& theory){
 	if(expr.type==EXPR_BOOL){
-		var.hasvalue = true;
-		var.mappedvalue = expr.boollit;
-		theory <<(expr.boollit?"":"-") <<var.var <<" 0\n";
+		addBoolValue(var, expr.boollit, theory);
 	}else if(expr.type==EXPR_ARRAYACCESS){
 		var.hasmap = true;
 		var.mappedvar = getBoolVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index)->var;
-		theory <<"Equiv C " <<var.var <<" | " <<var.mappedvar <<" 0\n";
+		theory.addEquivalence(var.var, true, Span<int>(&var.mappedvar, 1));
 	}else if(expr.type==EXPR_IDENT){
 		var.hasmap = true;
 		var.mappedvar = getBoolVar(*expr.ident->name)->var;
-		theory <<"Equiv C " <<var.var <<" | " <<var.mappedvar <<" 0\n";
+		theory.addEquivalence(var.var, true, Span<int>(&var.mappedvar, 1));
 	}else{ throw fzexception("Unexpected type.\n"); }
 }
 
-void Var::add(std::stringstream& vars, std::stringstream& theory){
+void Var::add(StatementBuffer&, StatementBuffer& theory){
 	if(type!=VAR_BOOL){ throw fzexception("Incorrect type.\n"); }
 
 	MBoolVar* var = createBoolVar(getName());
 	if(expr!=NULL){
-		addBoolExpr(*var, *expr, vars, theory);
+		addBoolExpr(*var, *expr, theory);
+	}
+	if(findAnnotation(*id, "output_var")!=NULL){
+		addOutputVar(getName(), *var);
 	}
 }
 
-void writeIntVar(const MIntVar& var, std::stringstream& vars){
+void writeIntVar(const MIntVar& var, StatementBuffer& vars){
 	if(var.range){
-		vars <<"INTVAR " <<var.var <<" " <<var.begin <<" " <<var.end <<" 0\n";
+		vars.addIntVar(var.var, var.begin, var.end);
 	}else{
-		vars <<"INTVARDOM " <<var.var <<" ";
-		for(vector<int>::const_iterator i=var.values.begin(); i<var.values.end(); ++i){
-			vars <<*i <<" ";
-		}
-		vars <<" 0\n";
+		vars.addIntVar(var.var, var.values);
+	}
+}
+
+void setIntValue(MIntVar& var, bool nobounds, int value){
+	var.hasvalue = true;
+	var.mappedvalue = value;
+	if(nobounds){
+		var.range = true;
+		var.begin = value;
+		var.end = value;
 	}
 }
 
+void addIntValue(MIntVar& var, bool nobounds, int value, StatementBuffer& vars, StatementBuffer& theory){
+	setIntValue(var, nobounds, value);
+	theory.addComparison(getTrue(vars), var.var, COMP_EQ, value);
+}
+
 //nobounds implies that it has not been written to output
-void addIntExpr(MIntVar& var, bool nobounds, const Expression& expr, std::stringstream& vars, std::stringstream& theory){
+void addIntExpr(MIntVar& var, bool nobounds, const Expression& expr, StatementBuffer& vars, StatementBuffer& theory){
 	if(expr.type==EXPR_INT){
-		var.hasvalue = true;
-		var.mappedvalue = expr.intlit;
-		if(nobounds){
-			var.range = true;
-			var.begin = var.mappedvalue;
-			var.end = var.mappedvalue;
-		}
+		setIntValue(var, nobounds, expr.intlit);
 	}else if(expr.type==EXPR_ARRAYACCESS){
 		assert(hasnobounds);
 		var.hasmap = true;
@@ -190,10 +501,42 @@ void addIntExpr(MIntVar& var, bool nobounds, const Expression& expr, std::string
 			var.values = map->values;
 		}
 	}else{ throw fzexception("Unexpected type.\n"); }
-	theory <<(var.hasvalue?"BINTRI ":"BINTRT ") <<getTrue(vars) <<" " <<var.var <<" = " <<(var.hasvalue?var.mappedvalue:var.mappedvar) <<" 0\n";
+	if(var.hasvalue){
+		theory.addComparison(getTrue(vars), var.var, COMP_EQ, var.mappedvalue);
+	}else{
+		theory.addVarComparison(getTrue(vars), var.var, COMP_EQ, var.mappedvar);
+	}
+}
+
+IntVar::IntVar(const vector<pair<int, int> >& unsorted): Var(VAR_INT), range(true), enumvalues(false), begin(1), end(0), values(NULL){
+	IntBitset domain(unsorted);
+	const vector<pair<int, int> >& ranges = domain.getRanges();
+	for(vector<pair<int, int> >::const_iterator i=ranges.begin(); i<ranges.end(); ++i){
+		if(i==ranges.begin()){
+			begin = (*i).first;
+		}else{
+			holes.push_back(pair<int, int>(end+1, (*i).first-1));
+		}
+		end = (*i).second;
+	}
+}
+
+//A hole of one value is a disequality, a wider one a clause over the bounds next to it
+void writeHoles(const MIntVar& var, const vector<pair<int, int> >& holes, StatementBuffer& vars, StatementBuffer& theory){
+	for(vector<pair<int, int> >::const_iterator i=holes.begin(); i<holes.end(); ++i){
+		if((*i).first==(*i).second){
+			theory.addComparison(getTrue(vars), var.var, COMP_NE, (*i).first);
+			continue;
+		}
+		int below = nextint++;
+		int above = nextint++;
+		theory.addComparison(below, var.var, COMP_LT, (*i).first);
+		theory.addComparison(above, var.var, COMP_GT, (*i).second);
+		theory.addBinary(below, above);
+	}
 }
 
-void IntVar::add(std::stringstream& vars, std::stringstream& theory){
+void IntVar::add(StatementBuffer& vars, StatementBuffer& theory){
 	if(type!=VAR_INT){ throw fzexception("Incorrect type.\n"); }
 
 	MIntVar* var = createIntVar(getName());
@@ -201,6 +544,7 @@ void IntVar::add(std::stringstream& vars, std::stringstream& theory){
 	//values
 	bool nobounds = true;
 	if(enumvalues){
+		MemoryScope records(MEM_RECORDS);
 		nobounds = false;
 		var->range = false;
 		var->values = *values;
@@ -217,76 +561,304 @@ void IntVar::add(std::stringstream& vars, std::stringstream& theory){
 		addIntExpr(*var, nobounds, *expr, vars, theory);
 	}
 	writeIntVar(*var, vars);
+	writeHoles(*var, holes, vars, theory);
+	if(findAnnotation(*id, "output_var")!=NULL){
+		addOutputVar(getName(), *var);
+	}
+}
+
+//Creates a membership literal for every value in the universe
+void initSetUniverse(MSetVar& var, const IntVar& universe){
+	MemoryScope records(MEM_RECORDS);
+	vector<int> values;
+	if(universe.enumvalues){
+		values = *universe.values;
+	}else if(universe.range){
+		vector<pair<int, int> >::const_iterator hole = universe.holes.begin();
+		for(long long i=universe.begin; i<=universe.end; ++i){
+			if(hole<universe.holes.end() && i==(*hole).first){
+				i = (*hole).second;
+				++hole;
+				continue;
+			}
+			values.push_back(i);
+		}
+	}else{
+		throw fzexception("Unbounded set types are not supported by the backend.\n");
+	}
+	if(values.size()==0){
+		return;
+	}
+	var.offset = *min_element(values.begin(), values.end());
+	var.lits.resize(*max_element(values.begin(), values.end())-var.offset+1, 0);
+	for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+		var.lits[*i-var.offset] = nextint++;
+	}
+}
+
+void addSetValue(MSetVar& var, const SetLiteral& value){
+	MemoryScope records(MEM_RECORDS);
+	var.hasvalue = true;
+	var.value = value.getSet();
+}
+
+//Returns 0 if the value is not in the universe of the set
+int FZ::getMembershipLit(const MSetVar& var, int value){
+	if(value<var.offset || value-var.offset>=(int)var.lits.size()){
+		return 0;
+	}
+	return var.lits[value-var.offset];
+}
+
+//A value outside the universe shows as fewer members in the universe than the size of the value
+void writeSetValue(const MSetVar& var, const IntBitset& value, StatementBuffer& theory){
+	long long members = 0;
+	for(unsigned int i=0; i<var.lits.size(); ++i){
+		if(var.lits[i]==0){
+			continue;
+		}
+		bool member = value.contains(var.offset+i);
+		members += member?1:0;
+		theory.addUnit(member?var.lits[i]:-var.lits[i]);
+	}
+	if(members!=value.size()){
+		throw fzexception("Set value outside of its universe.\n");
+	}
+}
+
+void addSetExpr(MSetVar& var, const Expression& expr, StatementBuffer& theory){
+	if(expr.type==EXPR_SET){
+		writeSetValue(var, expr.setlit->getSet(), theory);
+		return;
+	}
+
+	MSetVar* map;
+	if(expr.type==EXPR_ARRAYACCESS){
+		map = getSetVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}else if(expr.type==EXPR_IDENT){
+		map = getSetVar(*expr.ident->name);
+	}else{ throw fzexception("Unexpected type.\n"); }
+
+	if(map->hasvalue){
+		writeSetValue(var, map->value, theory);
+		return;
+	}
+	for(unsigned int i=0; i<var.lits.size(); ++i){
+		if(var.lits[i]==0){
+			continue;
+		}
+		int mappedlit = getMembershipLit(*map, var.offset+i);
+		if(mappedlit==0){
+			theory.addUnit(-var.lits[i]);
+		}else{
+			theory.addEquivalence(var.lits[i], true, Span<int>(&mappedlit, 1));
+		}
+	}
+	for(unsigned int i=0; i<map->lits.size(); ++i){
+		if(map->lits[i]!=0 && getMembershipLit(var, map->offset+i)==0){
+			theory.addUnit(-map->lits[i]);
+		}
+	}
+}
+
+void SetVar::add(StatementBuffer&, StatementBuffer& theory){
+	if(type!=VAR_SET){ throw fzexception("Incorrect type.\n"); }
+
+	MSetVar* set = createSetVar(getName());
+	if(!Var::var){
+		if(expr==NULL || expr->type!=EXPR_SET){ throw fzexception("Parameter sets have to be assigned a set literal.\n"); }
+		addSetValue(*set, *expr->setlit);
+		return;
+	}
+
+	initSetUniverse(*set, *var);
+	if(expr!=NULL){
+		addSetExpr(*set, *expr, theory);
+	}
+}
+
+// Returns NULL if the expression is not a boolean variable
+MBoolVar* findBoolVar(const Expression& expr){
+	if(expr.type==EXPR_IDENT){
+		return getBoolVar(*expr.ident->name);
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		return getBoolVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}
+	return NULL;
+}
+
+// Returns NULL if the expression is not an integer variable
+MIntVar* findIntVar(const Expression& expr){
+	if(expr.type==EXPR_IDENT){
+		return getIntVar(*expr.ident->name);
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		return getIntVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}
+	return NULL;
+}
+
+bool inDomain(const MIntVar& domain, int value){
+	if(domain.range){
+		return domain.begin<=value && value<=domain.end;
+	}
+	return find(domain.values.begin(), domain.values.end(), value)!=domain.values.end();
+}
+
+// True if every value of var is in the domain
+bool inDomain(const MIntVar& domain, const MIntVar& var){
+	if(var.range){
+		if(domain.range){
+			return domain.begin<=var.begin && var.end<=domain.end;
+		}
+		if((long long)var.end-var.begin>=(long long)domain.values.size()){
+			return false;
+		}
+		for(int i=var.begin; i<=var.end; ++i){
+			if(!inDomain(domain, i)){
+				return false;
+			}
+		}
+		return true;
+	}
+	for(vector<int>::const_iterator i=var.values.begin(); i<var.values.end(); ++i){
+		if(!inDomain(domain, *i)){
+			return false;
+		}
+	}
+	return true;
 }
 
-void ArrayVar::add(std::stringstream& vars, std::stringstream& theory){
-	if(type!=VAR_ARRAY || begin!=1 || end<begin){ throw fzexception("Incorrect type.\n"); }
+// Elements that are existing variables share their record, so they get no variable or statement of their own
+void ArrayVar::add(StatementBuffer& vars, StatementBuffer& theory){
+	if(type!=VAR_ARRAY || begin!=1 || end<0){ throw fzexception("Incorrect type.\n"); }
 
 	VAR_TYPE mappedtype = rangetype;
 	if(rangevar!=NULL){
 		mappedtype = rangevar->type;
 	}
 
-	if(arraylit!=NULL && arraylit->exprs->size()!=0){
-		if((int)arraylit->exprs->size() != end){
+	//An empty array has no elements that give it a type, so it is also an empty array of the other types
+	if(end==0){
+		if(mappedtype!=VAR_BOOL){
+			createBoolArrayVar(getName(), 0);
+		}
+		if(mappedtype!=VAR_SET){
+			createSetArrayVar(getName(), 0);
+		}
+		if(mappedtype==VAR_BOOL || mappedtype==VAR_SET){
+			createIntArrayVar(getName(), 0);
+		}
+	}
+
+	if(arraylit!=NULL && arraylit->size()!=0){
+		if(arraylit->size() != end){
 			throw fzexception("Incorrect nb of expressions.\n");
 		}
 	}
 
+	const Expression* output = findAnnotation(*id, "output_array");
+
+	bool initialized = arraylit!=NULL && arraylit->size()!=0;
+
 	if(mappedtype==VAR_BOOL){
 		MBoolArrayVar* var = createBoolArrayVar(getName(), end);
-		for(int i=1; i<=end; i++){
-			MBoolVar* boolvar = new MBoolVar();
-			boolvar->var = nextint++;
-			boolvar->hasmap = false;
-			boolvar->hasvalue = false;
+		bool values = initialized && arraylit->literals==LITERALS_BOOL;
+		const vector<Expression*>* exprs = initialized && !values?&arraylit->getExprs():NULL;
+		for(int i=0; i<end; i++){
+			MBoolVar* boolvar = exprs!=NULL?findBoolVar(*(*exprs)[i]):NULL;
+			if(boolvar==NULL){
+				{
+					MemoryScope records(MEM_RECORDS);
+					boolvar = new MBoolVar();
+				}
+				boolvar->var = nextint++;
+				boolvar->hasmap = false;
+				boolvar->hasvalue = false;
+				if(values){
+					addBoolValue(*boolvar, (*arraylit->values)[i]!=0, theory);
+				}else if(exprs!=NULL){
+					addBoolExpr(*boolvar, *(*exprs)[i], theory);
+				}
+			}
+			MemoryScope records(MEM_RECORDS);
 			var->vars.push_back(boolvar);
 		}
-		// values
-		if(arraylit!=NULL){
-			int index = 1;
-			for(vector<Expression*>::const_iterator i=arraylit->exprs->begin(); i<arraylit->exprs->end(); ++i, ++index){
-				addBoolExpr(*var->vars[index], **i, vars, theory);
+		if(output!=NULL){
+			addOutputArray(getName(), *output, var->vars);
+		}
+	}else if(mappedtype==VAR_SET){
+		MSetArrayVar* var = createSetArrayVar(getName(), end);
+		SetVar* rangedvar = dynamic_cast<SetVar*>(rangevar);
+		const vector<Expression*>* exprs = initialized?&arraylit->getExprs():NULL;
+		MemoryScope records(MEM_RECORDS);
+		for(int i=0; i<end; i++){
+			Expression* expr = exprs!=NULL?(*exprs)[i]:NULL;
+			if(expr!=NULL && expr->type==EXPR_SET && !this->var){
+				MSetVar* setvar = new MSetVar();
+				setvar->offset = 0;
+				addSetValue(*setvar, *expr->setlit);
+				var->vars.push_back(setvar);
+			}else if(expr!=NULL && expr->type==EXPR_IDENT){
+				var->vars.push_back(getSetVar(*expr->ident->name));
+			}else if(expr!=NULL && expr->type==EXPR_ARRAYACCESS){
+				var->vars.push_back(getSetVar(*expr->arrayaccesslit->id, expr->arrayaccesslit->index));
+			}else{
+				if(rangedvar==NULL){ throw fzexception("Incorrect type.\n"); }
+				MSetVar* setvar = new MSetVar();
+				setvar->hasvalue = false;
+				initSetUniverse(*setvar, *rangedvar->var);
+				if(expr!=NULL){
+					addSetExpr(*setvar, *expr, theory);
+				}
+				var->vars.push_back(setvar);
 			}
 		}
 	}else{
 		MIntArrayVar* var = createIntArrayVar(getName(), end);
 
-		MIntVar* intvar = new MIntVar();
-		intvar->var = nextint++;
-		intvar->hasmap = false;
-		intvar->hasvalue = false;
+		//The new elements are copies of this one, each with their own variable
+		MIntVar intvar;
+		intvar.var = 0;
+		intvar.hasmap = false;
+		intvar.hasvalue = false;
 		bool nobounds = true;
 		if(rangevar!=NULL){
 			IntVar* rangedvar = dynamic_cast<IntVar*>(rangevar);
 			if(rangedvar->enumvalues){
 				nobounds = false;
-				intvar->range = false;
-				intvar->values = *rangedvar->values;
+				intvar.range = false;
+				intvar.values = *rangedvar->values;
 			}else if(rangedvar->range){
 				nobounds = false;
-				intvar->range = true;
-				intvar->begin = rangedvar->begin;
-				intvar->end = rangedvar->end;
+				intvar.range = true;
+				intvar.begin = rangedvar->begin;
+				intvar.end = rangedvar->end;
 			}
 		}
 
-		for(int i=1; i<=end; i++){
-			MIntVar* tempvar = new MIntVar(*intvar);
-			intvar->var = nextint++;
-			var->vars.push_back(tempvar);
-		}
-
-		// values
-		if(arraylit!=NULL){
-			int index = 0;
-			for(vector<Expression*>::const_iterator i=arraylit->exprs->begin(); i<arraylit->exprs->end(); ++i, ++index){
-				addIntExpr(*var->vars[index], nobounds, **i, vars, theory);
+		bool values = initialized && arraylit->literals==LITERALS_INT;
+		const vector<Expression*>* exprs = initialized && !values?&arraylit->getExprs():NULL;
+		for(int i=0; i<end; i++){
+			// A variable with values outside the domain of the array still gets a copy, which restricts it
+			MIntVar* intvarptr = exprs!=NULL?findIntVar(*(*exprs)[i]):NULL;
+			if(intvarptr==NULL || (!nobounds && !inDomain(intvar, *intvarptr))){
+				{
+					MemoryScope records(MEM_RECORDS);
+					intvarptr = new MIntVar(intvar);
+				}
+				intvarptr->var = nextint++;
+				if(values){
+					addIntValue(*intvarptr, nobounds, (*arraylit->values)[i], vars, theory);
+				}else if(exprs!=NULL){
+					addIntExpr(*intvarptr, nobounds, *(*exprs)[i], vars, theory);
+				}
+				writeIntVar(*intvarptr, vars);
 			}
+			MemoryScope records(MEM_RECORDS);
+			var->vars.push_back(intvarptr);
 		}
-
-		for(vector<MIntVar*>::const_iterator i=var->vars.begin(); i<var->vars.end(); ++i){
-			writeIntVar(**i, vars);
+		if(output!=NULL){
+			addOutputArray(getName(), *output, var->vars);
 		}
 	}
 }
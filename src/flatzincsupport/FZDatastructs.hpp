@@ -46,6 +46,32 @@ void deleteList(std::vector<T*>* list){
 class Identifier;
 class Expression;
 class ArrayLiteral;
+class StatementBuffer;
+
+/**
+ * A set of integers stored as a bitset of machine words, starting at offset.
+ * Values that lie too far apart for a bitset are stored as a sorted vector instead, a range only by its bounds.
+ */
+class IntBitset{
+private:
+	int offset;
+	std::vector<unsigned long> words;
+	std::vector<int> sorted;
+	std::vector<std::pair<int, int> > ranges;	//Sorted and disjoint
+
+public:
+	IntBitset(): offset(0){}
+	IntBitset(const std::vector<int>& values);
+	IntBitset(int begin, int end);
+	IntBitset(const std::vector<std::pair<int, int> >& ranges);
+
+	bool contains(int value) const;
+	long long size() const;
+	//Lists every value, so a range is only listed when its values are needed one by one
+	void getValues(std::vector<int>& values) const;
+	//Empty if the values are enumerated
+	const std::vector<std::pair<int, int> >& getRanges() const { return ranges; }
+};
 
 struct Identifier{
 	std::string* name;
@@ -68,25 +94,45 @@ struct ArrayAccess{
 	}
 };
 
+enum LITERALS_TYPE { LITERALS_NONE, LITERALS_INT, LITERALS_BOOL };
+
+//Arrays of only int or only bool literals keep their values in one buffer instead of an expression per element
 struct ArrayLiteral{
-	std::vector<Expression*>* exprs;
+	std::vector<Expression*>* exprs;	//NULL if the elements are in values
+	LITERALS_TYPE literals;
+	std::vector<int>* values;			//Bools are stored as 1 and 0
 
-	ArrayLiteral():exprs(NULL){}
+	ArrayLiteral():exprs(new std::vector<Expression*>()), literals(LITERALS_NONE), values(NULL){}
 	~ArrayLiteral(){
 		if(exprs!=NULL){ deleteList(exprs); }
+		if(values!=NULL){ delete(values); }
 	}
+
+	int size() const { return exprs!=NULL?exprs->size():values->size(); }
+
+	void add(Expression* expr);
+	void addInt(int value);
+	void addBool(bool value);
+
+	//Creates the expressions of a literal array for the consumers that need them
+	const std::vector<Expression*>& getExprs();
 };
 
+//Enumerated sets are stored as a bitset, ranges only by their bounds
 struct SetLiteral{
 	bool range;
-	std::vector<int>* values;
+	IntBitset* values;
 	int begin, end;
 
-	SetLiteral(std::vector<int>* values): range(false), values(values){}
+	SetLiteral(std::vector<int>* values): range(false), values(new IntBitset(*values)), begin(0), end(0){ delete(values); }
 	SetLiteral(int begin, int end): range(true), values(NULL), begin(begin), end(end){}
+	SetLiteral(const std::vector<std::pair<int, int> >& ranges): range(false), values(new IntBitset(ranges)), begin(0), end(0){}
 	~SetLiteral(){
 		if(values!=NULL){ delete(values); }
 	}
+
+	bool contains(int value) const { return range?(begin<=value && value<=end):values->contains(value); }
+	IntBitset getSet() const { return range?IntBitset(begin, end):*values; }
 };
 
 enum EXPR_TYPE {EXPR_BOOL, EXPR_INT, EXPR_SET, EXPR_ARRAY, EXPR_FLOAT, EXPR_STRING, EXPR_ARRAYACCESS, EXPR_IDENT};
@@ -128,6 +174,14 @@ struct MIntVar{
 	std::vector<int> values;
 };
 
+struct MSetVar{
+	bool hasvalue;	//Parameter sets only store their value
+	IntBitset value;
+
+	int offset;				//lits[i] is the membership literal of value offset+i
+	std::vector<int> lits;	//0 if that value is not in the universe of the set
+};
+
 struct MBoolArrayVar{
 	std::vector<MBoolVar*> vars;
 	int nbelem;
@@ -138,15 +192,29 @@ struct MIntArrayVar{
 	int nbelem;
 };
 
+struct MSetArrayVar{
+	std::vector<MSetVar*> vars;
+	int nbelem;
+};
+
 int createOneShotVar();
+int getMaxVar();	// The variables are numbered 1..getMaxVar()
+void clearSymbols();	// Forgets all variables, to start a new translation
 MBoolVar* getBoolVar(const std::string& name);
 MIntVar* getIntVar(const std::string& name);
 MBoolVar* getBoolVar(const std::string& name, int index);
 MIntVar* getIntVar(const std::string& name, int index);
+MBoolArrayVar* getBoolArrayVar(const std::string& name);
+MIntArrayVar* getIntArrayVar(const std::string& name);
+MSetVar* getSetVar(const std::string& name);
+MSetVar* getSetVar(const std::string& name, int index);
+int getMembershipLit(const MSetVar& var, int value);
 int getVar(const std::string& name, bool expectbool);
 int getVar(const std::string& name, int index, bool expectbool);
-int getTrue(std::ostream& vars);
-int getFalse(std::ostream& vars);
+int getTrue(StatementBuffer& vars);
+int getFalse(StatementBuffer& vars);
+// The annotations the translator reads, the lexer skips all others without building their expressions
+bool isReadAnnotation(const char* name, size_t length);
 
 enum VAR_TYPE {VAR_BOOL, VAR_INT, VAR_SET, VAR_FLOAT, VAR_ARRAY};
 
@@ -164,7 +232,7 @@ public:
 
 	const std::string& getName() const { return *id->name; }
 
-	virtual void add(std::stringstream& vars, std::stringstream& theory);
+	virtual void add(StatementBuffer& vars, StatementBuffer& theory);
 };
 
 class IntVar: public Var{
@@ -173,15 +241,17 @@ public:
 	bool enumvalues;
 	int begin, end;
 	std::vector<int>* values;
+	std::vector<std::pair<int, int> > holes;	//A domain of several ranges is the range around them without these
 
 	IntVar(): Var(VAR_INT), range(false), enumvalues(false), values(NULL){}
 	IntVar(int begin, int end): Var(VAR_INT), range(true), enumvalues(false), begin(begin), end(end), values(NULL){}
 	IntVar(std::vector<int>* values): Var(VAR_INT), range(false), enumvalues(true), values(values){}
+	IntVar(const std::vector<std::pair<int, int> >& ranges);
 	virtual ~IntVar(){
 		if(values!=NULL){ delete(values); }
 	};
 
-	void add(std::stringstream& vars, std::stringstream& theory);
+	void add(StatementBuffer& vars, StatementBuffer& theory);
 };
 
 class SetVar: public Var{
@@ -192,6 +262,8 @@ public:
 	virtual ~SetVar(){
 		delete(var);
 	};
+
+	void add(StatementBuffer& vars, StatementBuffer& theory);
 };
 
 class ArrayVar: public Var{
@@ -214,7 +286,7 @@ public:
 		if(arraylit!=NULL) { delete(arraylit); }
 	};
 
-	void add(std::stringstream& vars, std::stringstream& theory);
+	void add(StatementBuffer& vars, StatementBuffer& theory);
 };
 
 enum SOLVE_TYPE { SOLVE_SATISFY, SOLVE_MINIMIZE, SOLVE_MAXIMIZE};
@@ -232,9 +304,10 @@ struct Search{
 
 struct Constraint{
 	Identifier* id;
+	int type;	// The CONSTRAINT_TYPE, resolved when the name is parsed, -1 if it is not supported
 	std::vector<Expression*>* annotations;
 
-	Constraint(Identifier* id):id(id), annotations(NULL){}
+	Constraint(Identifier* id):id(id), type(-1), annotations(NULL){}
 	~Constraint(){
 		if(id!=NULL){ delete(id); }
 		if(annotations!=NULL){ deleteList(annotations); }
@@ -10,45 +10,148 @@
 
 #include <cstdio>
 #include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "flatzincsupport/FZDatastructs.hpp"
 #include "flatzincsupport/InsertWrapper.hpp"
-#include "flatzincsupport/flatzincparser.h"
+#include "flatzincsupport/EcnfSink.hpp"
+#include "flatzincsupport/ParseContext.hpp"
+#include "flatzincsupport/ParallelParser.hpp"
+#include "flatzincsupport/JsonParser.hpp"
 #include "flatzincsupport/fzexception.hpp"
+#include "flatzincsupport/Statistics.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
 
 using namespace std;
 using namespace FZ;
 
-extern InsertWrapper* wrapper;
-extern FILE* fzin;
-extern int fzparse(void);
+FlatZincMX::FlatZincMX(): ownedsink(new TextSink(cout)), data(NULL), threads(1) {
+	clearSymbols();
+	data = new InsertWrapper(*ownedsink);
+}
 
-FlatZincMX::FlatZincMX(): data(new InsertWrapper()) {
-	wrapper = data;
+FlatZincMX::FlatZincMX(EcnfSink& sink): ownedsink(NULL), data(NULL), threads(1) {
+	clearSymbols();
+	data = new InsertWrapper(sink);
 }
 
 FlatZincMX::~FlatZincMX() {
 	delete data;
+	delete ownedsink;
 }
 
 void FlatZincMX::parse(bool readfromstdin, const std::string& inputfile){
-	int result = 0;
 	if(readfromstdin){
-		fzin = stdin;
-		result = fzparse();
+		parse(stdin);
+	}else if(threads>1){
+		parseMapped(inputfile);
 	}else{
-		fzin = fopen(inputfile.c_str(),"r");
-		if(fzin){
-			result = fzparse();
-			fclose(fzin);
-		}else{
+		FILE* in = fopen(inputfile.c_str(),"r");
+		if(in==NULL){
 			throw fzexception("File could not be opened, aborting.\n");
 		}
+		try{
+			parse(in);
+		}catch(const fzexception&){
+			fclose(in);
+			throw;
+		}
+		fclose(in);
+	}
+}
+
+// The input has already been read, e.g. to look it up in the translation cache
+void FlatZincMX::parse(const std::string& input){
+	if(threads>1 || isJson(input.data(), input.data()+input.size())){
+		parse(input.data(), input.size());
+		return;
+	}
+	FILE* in = fmemopen(const_cast<char*>(input.data()), input.size(), "r");
+	if(in==NULL){
+		throw fzexception("Unspecified parsing error.\n");
 	}
+	try{
+		parse(in);
+	}catch(const fzexception&){
+		fclose(in);
+		throw;
+	}
+	fclose(in);
+}
+
+void FlatZincMX::parse(FILE* in){
+	std::string json;
+	if(readJson(in, json)){
+		parse(json.data(), json.size());
+		return;
+	}
+	MemoryScope ast(MEM_AST);
+	Statistics& stats = getStatistics();
+	double start = currentTime();
+	ParseContext context(in, data);
+	int result = FZ::parse(context);
 	if(result!=0){
 		throw fzexception("Unspecified parsing error.\n");
 	}
+	// Whatever is not spent in the items themselves is spent in lexing and parsing
+	stats.phasetime[PHASE_PARSING] += currentTime()-start-stats.phasetime[PHASE_DECLARATIONS]-stats.phasetime[PHASE_CONSTRAINTS];
+}
+
+// The file is mapped instead of read, the threads parse their chunks straight from the page cache
+void FlatZincMX::parseMapped(const std::string& inputfile){
+	int file = open(inputfile.c_str(), O_RDONLY);
+	struct stat info;
+	if(file<0 || fstat(file, &info)!=0){
+		if(file>=0){
+			close(file);
+		}
+		throw fzexception("File could not be opened, aborting.\n");
+	}
+	size_t size = info.st_size;
+	void* input = size==0?NULL:mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if(input==MAP_FAILED){
+		throw fzexception("File could not be opened, aborting.\n");
+	}
+	if(input!=NULL){
+		madvise(input, size, MADV_SEQUENTIAL);
+	}
+	try{
+		parse((const char*)input, size);
+	}catch(...){
+		if(input!=NULL){
+			munmap(input, size);
+		}
+		throw;
+	}
+	if(input!=NULL){
+		munmap(input, size);
+	}
+}
+
+void FlatZincMX::parse(const char* input, size_t size){
+	Statistics& stats = getStatistics();
+	double start = currentTime();
+	if(isJson(input, input+size)){
+		MemoryScope ast(MEM_AST);
+		parseJson(input, input+size, *data);
+	}else{
+		parseChunks(input, size, threads, *data);
+	}
+	// Only the time the translation waits for the parser is counted as parsing
+	stats.phasetime[PHASE_PARSING] += currentTime()-start-stats.phasetime[PHASE_DECLARATIONS]-stats.phasetime[PHASE_CONSTRAINTS];
 }
 
 void FlatZincMX::writeout(){
+	MemoryScope output(MEM_OUTPUT);
+	Statistics& stats = getStatistics();
+	double start = currentTime();
+	data->finish();
+	stats.phasetime[PHASE_OUTPUT] += currentTime()-start;
+	if(stats.enabled){
+		data->addOutputStatistics();
+	}
 }
@@ -9,22 +9,40 @@
 #ifndef FLATZINCMX_HPP_
 #define FLATZINCMX_HPP_
 
+#include <cstdio>
 #include <vector>
 #include <string>
 
 namespace FZ{
 class InsertWrapper;
+class EcnfSink;
 
+/**
+ * Translates one FlatZinc model, with the options of getTranslationOptions().
+ * The translator has global state, so only one can exist at a time.
+ */
 class FlatZincMX {
 private:
+	EcnfSink* ownedsink;
 	InsertWrapper* data;
+	int threads;
 
 	const InsertWrapper& getData() const { return *data; }
+
+	void parse(FILE* in);
+	void parse(const char* input, size_t size);
+	void parseMapped(const std::string& inputfile);
 public:
-	FlatZincMX();
+	FlatZincMX();	// Writes ECNF text to cout
+	FlatZincMX(EcnfSink& sink);
 	virtual ~FlatZincMX();
 
+	// With more than one thread, a file or an input string is split into chunks that are parsed in parallel
+	void setThreads(int nbthreads) { threads = nbthreads; }
+
+	// FlatZinc in JSON is recognized by its content and read by parseJson, on one thread
 	void parse(bool readfromstdin, const std::string& inputfile);
+	void parse(const std::string& input);
 	void writeout();
 };
 }
@@ -10,11 +10,19 @@
 
 #include <assert.h>
 #include <string>
+#include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstdlib>
+#include <climits>
 
 #include "flatzincsupport/FZDatastructs.hpp"
 #include "flatzincsupport/fzexception.hpp"
+#include "flatzincsupport/Statistics.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
+#include "flatzincsupport/Renumbering.hpp"
+#include "flatzincsupport/VariableMap.hpp"
+#include "flatzincsupport/SearchHints.hpp"
 
 using namespace std;
 using namespace FZ;
@@ -24,69 +32,96 @@ using namespace FZ;
 // Default ID is hardcoded
 int defaultdefID = 0;
 
-InsertWrapper::InsertWrapper(){
-	name2type["bool2int"] = bool2int;
-	name2type["bool_and"] = booland;
-	name2type["bool_clause"] = boolclause;
-	name2type["bool_eq"] = booleq;
-	name2type["bool_eq_reif"] = booleqr;
-	name2type["bool_le"] = boolle;
-	name2type["bool_le_reif"] = booller;
-	name2type["bool_lt"] = boollt;
-	name2type["bool_lt_reif"] = boolltr;
-	name2type["bool_not"] = boolnot;
-	name2type["bool_or"] = boolor;
-	name2type["bool_xor"] = boolxor;
-
-	name2type["int_abs"] = intabs;
-	name2type["int_div"] = intdiv;
-	name2type["int_eq"] = inteq;
-	name2type["int_eq_reif"] = inteqr;
-	name2type["int_le"] = intle;
-	name2type["int_le_reif"] = intler;
-	name2type["int_lt"] = intlt;
-	name2type["int_lt_reif"] = intltr;
-	name2type["int_max"] = intmax;
-	name2type["int_min"] = intmin;
-	name2type["int_mod"] = intmod;
-	name2type["int_ne"] = intne;
-	name2type["int_ne_reif"] = intner;
-	name2type["int_plus"] = intplus;
-	name2type["int_times"] = inttimes;
-	name2type["int_lin_eq"] = intlineq;
-	name2type["int_lin_eq_reif"] = intlineqr;
-	name2type["int_lin_le"] = intlinle;
-	name2type["int_lin_le_reif"] = intlinler;
-	name2type["int_lin_ne"] = intlinne;
-	name2type["int_lin_ne_reif"] = intlinner;
-
-	name2type["array_bool_and"] = arraybooland;
-	name2type["array_bool_or"] = arrayboolor;
+InsertWrapper::InsertWrapper(EcnfSink& sink): sink(sink), defining(false), definitionid(0), truelit(0), falselit(0),
+		unsatisfiable(false), nextsetid(1){
 }
 
 InsertWrapper::~InsertWrapper() {
-	for(map<int, stringstream*>::iterator i=definitions.begin(); i!=definitions.end(); ++i){
-		delete((*i).second);
-	}
 }
 
 void InsertWrapper::start(){
-	cout <<"c Automated transformation from a flatzinc model into ECNF.\n";
-	cout <<"p ecnf\n";
+	sink.start();
 }
 
 void InsertWrapper::finish(){
-	cout <<vars.str();
-	cout <<theory.str();
+	const TranslationOptions& options = getTranslationOptions();
+	writeDefinitions();
+	if(options.pbfusion){
+		fuseLinears();
+	}
+	if(options.halfreify){
+		halfReify();
+	}
+	if(options.renumbering!=RENUMBER_NONE || options.compact){
+		rename(options);
+	}
+	vars.replay(sink);
+	theory.replay(sink);
+	const vector<SearchHint>& hints = getSearchHints();
+	for(vector<SearchHint>::const_iterator i=hints.begin(); i<hints.end(); ++i){
+		sink.addSearch((*i).booleans, (*i).vars, (*i).varselect, (*i).valselect, (*i).strategy);
+	}
+	sink.finish();
+}
+
+//Renames all variables in the output and in the variable map
+void InsertWrapper::rename(const TranslationOptions& options){
+	vector<const StatementBuffer*> buffers;
+	buffers.push_back(&vars);
+	buffers.push_back(&theory);
+	vector<int> names;
+	if(options.renumbering!=RENUMBER_NONE){
+		getLocalityOrder(buffers, getMaxVar(), options.renumbering, names);
+	}else{
+		for(int v=0; v<=getMaxVar(); ++v){
+			names.push_back(v);
+		}
+	}
+	if(options.compact){
+		compactNumbering(buffers, names);
+	}
+
+	renameVariables(vars, names);
+	renameVariables(theory, names);
+	renameOutputVariables(names);
+	renameSearchHints(names);
+}
+
+void InsertWrapper::addOutputStatistics() const{
+	Statistics& stats = getStatistics();
+	stats.countStatements(vars);
+	stats.countStatements(theory);
 }
 
 void InsertWrapper::add(Var* var){
+	MemoryScope output(MEM_OUTPUT);
+	Statistics& stats = getStatistics();
+	double start = stats.enabled?currentTime():0;
 	var->add(vars, theory);
+	if(stats.enabled){
+		stats.phasetime[PHASE_DECLARATIONS] += currentTime()-start;
+	}
+}
+
+int InsertWrapper::parseBoolValue(bool value){
+	return value?getTrueLit():getFalseLit();
+}
+
+//Every constant is one variable
+int InsertWrapper::parseIntValue(int value){
+	map<int, int>::const_iterator known = constants.find(value);
+	if(known!=constants.end()){
+		return (*known).second;
+	}
+	int varnb = createOneShotVar();
+	vars.addIntVar(varnb, value, value);
+	constants[value] = varnb;
+	return varnb;
 }
 
 int InsertWrapper::parseBool(const Expression& expr){
 	if(expr.type==EXPR_BOOL){
-		return (expr.boollit?getTrue(vars):getFalse(vars));
+		return parseBoolValue(expr.boollit);
 	}else if(expr.type==EXPR_ARRAYACCESS){
 		return getVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index, true);
 	}else if(expr.type==EXPR_IDENT){
@@ -96,9 +131,7 @@ int InsertWrapper::parseBool(const Expression& expr){
 
 int InsertWrapper::parseInt(const Expression& expr){
 	if(expr.type==EXPR_INT){
-		int varnb = createOneShotVar();
-		vars <<"INTVAR " <<varnb <<" " <<expr.intlit <<" " <<expr.intlit <<" 0\n";
-		return varnb;
+		return parseIntValue(expr.intlit);
 	}else if(expr.type==EXPR_ARRAYACCESS){
 		return getVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index, false);
 	}else if(expr.type==EXPR_IDENT){
@@ -106,21 +139,49 @@ int InsertWrapper::parseInt(const Expression& expr){
 	}else{ throw fzexception("Unexpected type.\n"); }
 }
 
+//A named parameter gives its value, not its variable
 int InsertWrapper::parseParInt(const Expression& expr){
-	if(expr.type==EXPR_INT){
-		return expr.intlit;
-	}else if(expr.type==EXPR_ARRAYACCESS){
-		return getVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index, false);
-	}else if(expr.type==EXPR_IDENT){
-		return getVar(*expr.ident->name, false);
-	}else{ throw fzexception("Unexpected type.\n"); }
+	if(expr.type!=EXPR_INT && expr.type!=EXPR_ARRAYACCESS && expr.type!=EXPR_IDENT){ throw fzexception("Unexpected type.\n"); }
+	int value;
+	if(!getFixedValue(expr, false, value)){
+		throw fzexception("Expected a parameter with a value.\n");
+	}
+	return value;
 }
 
+//An array can also be referred to by name, then its elements are the variables of the stored elements
 vector<int> InsertWrapper::parseArray(VAR_TYPE type, Expression& expr){
+	vector<int> elems;
+	if(expr.type==EXPR_IDENT && type==VAR_BOOL){
+		const vector<MBoolVar*>& elements = getBoolArrayVar(*expr.ident->name)->vars;
+		elems.reserve(elements.size());
+		for(vector<MBoolVar*>::const_iterator i=elements.begin(); i<elements.end(); ++i){
+			elems.push_back((*i)->var);
+		}
+		return elems;
+	}
+	if(expr.type==EXPR_IDENT){
+		const vector<MIntVar*>& elements = getIntArrayVar(*expr.ident->name)->vars;
+		elems.reserve(elements.size());
+		for(vector<MIntVar*>::const_iterator i=elements.begin(); i<elements.end(); ++i){
+			elems.push_back((*i)->var);
+		}
+		return elems;
+	}
 	if(expr.type!=EXPR_ARRAY){ throw fzexception("Unexpected type.\n"); }
 
-	vector<int> elems;
-	for(vector<Expression*>::const_iterator i=expr.arraylit->exprs->begin(); i<expr.arraylit->exprs->end(); ++i){
+	const ArrayLiteral& array = *expr.arraylit;
+	elems.reserve(array.size());
+	if(array.literals!=LITERALS_NONE && (array.literals==LITERALS_BOOL)!=(type==VAR_BOOL)){
+		throw fzexception("Unexpected type.\n");
+	}
+	if(array.literals!=LITERALS_NONE){
+		for(vector<int>::const_iterator i=array.values->begin(); i<array.values->end(); ++i){
+			elems.push_back(type==VAR_BOOL?parseBoolValue(*i!=0):parseIntValue(*i));
+		}
+		return elems;
+	}
+	for(vector<Expression*>::const_iterator i=array.exprs->begin(); i<array.exprs->end(); ++i){
 		if(type==VAR_BOOL){
 			elems.push_back(parseBool(**i));
 		}else{
@@ -130,29 +191,83 @@ vector<int> InsertWrapper::parseArray(VAR_TYPE type, Expression& expr){
 	return elems;
 }
 
+//A parameter array can also be referred to by name, then its values are read from the stored elements
 vector<int> InsertWrapper::parseParIntArray(Expression& expr){
+	vector<int> elems;
+	if(expr.type==EXPR_IDENT){
+		const MIntArrayVar& array = *getIntArrayVar(*expr.ident->name);
+		elems.reserve(array.vars.size());
+		for(vector<MIntVar*>::const_iterator i=array.vars.begin(); i<array.vars.end(); ++i){
+			if(!(*i)->hasvalue){ throw fzexception("Expected a parameter array.\n"); }
+			elems.push_back((*i)->mappedvalue);
+		}
+		return elems;
+	}
 	if(expr.type!=EXPR_ARRAY){ throw fzexception("Unexpected type.\n"); }
 
-	vector<int> elems;
-	for(vector<Expression*>::const_iterator i=expr.arraylit->exprs->begin(); i<expr.arraylit->exprs->end(); ++i){
+	const ArrayLiteral& array = *expr.arraylit;
+	if(array.literals==LITERALS_INT){
+		return *array.values;
+	}
+	if(array.literals==LITERALS_BOOL){ throw fzexception("Unexpected type.\n"); }
+	elems.reserve(array.exprs->size());
+	for(vector<Expression*>::const_iterator i=array.exprs->begin(); i<array.exprs->end(); ++i){
 		elems.push_back(parseParInt(**i));
 	}
 	return elems;
 }
 
-void InsertWrapper::parseArgs(const vector<Expression*>& origargs, vector<int>& args, const vector<ARG_TYPE>& expectedtypes){
-	if(origargs.size()!=expectedtypes.size()){
+//Returns 1 for true and 0 for false
+vector<int> InsertWrapper::parseParBoolArray(Expression& expr){
+	vector<int> elems;
+	if(expr.type==EXPR_IDENT){
+		const MBoolArrayVar& array = *getBoolArrayVar(*expr.ident->name);
+		elems.reserve(array.vars.size());
+		for(vector<MBoolVar*>::const_iterator i=array.vars.begin(); i<array.vars.end(); ++i){
+			if(!(*i)->hasvalue){ throw fzexception("Expected a parameter array.\n"); }
+			elems.push_back((*i)->mappedvalue?1:0);
+		}
+		return elems;
+	}
+	if(expr.type!=EXPR_ARRAY){ throw fzexception("Unexpected type.\n"); }
+
+	const ArrayLiteral& array = *expr.arraylit;
+	if(array.literals==LITERALS_BOOL){
+		return *array.values;
+	}
+	if(array.literals==LITERALS_INT){ throw fzexception("Unexpected type.\n"); }
+	elems.reserve(array.exprs->size());
+	for(vector<Expression*>::const_iterator i=array.exprs->begin(); i<array.exprs->end(); ++i){
+		if((*i)->type!=EXPR_BOOL){ throw fzexception("Unexpected type.\n"); }
+		elems.push_back((*i)->boollit?1:0);
+	}
+	return elems;
+}
+
+//Constant sets keep their value, without membership literals
+void InsertWrapper::parseSet(const Expression& expr, MSetVar& set){
+	if(expr.type==EXPR_SET){
+		set.hasvalue = true;
+		set.value = expr.setlit->getSet();
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		set = *getSetVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}else if(expr.type==EXPR_IDENT){
+		set = *getSetVar(*expr.ident->name);
+	}else{ throw fzexception("Unexpected type.\n"); }
+}
+
+//Only parses the scalar arguments, the others are left 0
+void InsertWrapper::parseArgs(const vector<Expression*>& origargs, int* args, const ConstraintSignature& signature){
+	if((int)origargs.size()!=signature.nbargs){
 		throw fzexception("Incorrect number of arguments.\n");
 	}
-	unsigned int itype=0;
-	for(vector<Expression*>::const_reverse_iterator i=origargs.rbegin(); i<origargs.rend(); ++i, ++itype){
-		ARG_TYPE expectedtype = expectedtypes[itype];
-		Expression& expr = **i;
-		switch(expectedtype){
-		case ARG_BOOL: args.push_back(parseBool(expr)); break;
-		case ARG_INT: args.push_back(parseInt(expr)); break;
-		default:
-			throw fzexception("Unexpected type.\n");
+	for(int i=0; i<signature.nbargs; ++i){
+		Expression& expr = *origargs[i];
+		switch(signature.args[i]){
+		case ARG_BOOL: args[i] = parseBool(expr); break;
+		case ARG_INT: args[i] = parseInt(expr); break;
+		case ARG_PAR_INT: args[i] = parseParInt(expr); break;
+		default: args[i] = 0; break;
 		}
 	}
 }
@@ -161,10 +276,10 @@ bool hasDefinitionAnnotation(const vector<Expression*>& args, int& definitionid)
 	bool defined = false;
 	for(vector<Expression*>::const_iterator i=args.begin(); i<args.end(); ++i){
 		if((*i)->type==EXPR_IDENT && (*i)->ident->name->compare("inductivelydefined")==0){
-			if((*i)->ident->arguments!=NULL){
+			if((*i)->ident->arguments!=NULL && (*i)->ident->arguments->size()>0){
 				if((*i)->ident->arguments->size()==1 && (*(*i)->ident->arguments->begin())->type==EXPR_INT){
 					definitionid = (*(*i)->ident->arguments->begin())->intlit;
-				}else{ throw fzexception("Incorrect number of annotation arguments");}
+				}else{ throw fzexception("Incorrect number of annotation arguments.\n");}
 			}else{
 				definitionid = defaultdefID;
 			}
@@ -175,272 +290,1315 @@ bool hasDefinitionAnnotation(const vector<Expression*>& args, int& definitionid)
 }
 
 void InsertWrapper::writeRule(int head, const vector<int>& rhs, bool conj, int definitionID){
-	theory <<(conj?"C":"D") <<" | " <<definitionID <<" " <<head <<" ";
-	for(vector<int>::const_iterator i=rhs.begin(); i<rhs.end(); ++i){
-		theory <<*i <<" ";
+	theory.addRule(definitionID, head, conj, rhs);
+}
+//Inside an inductive definition, the constraint is a rule of it instead
+void InsertWrapper::writeRuleOrEquiv(int head, const int* rhs, int size, bool conj){
+	if(!defining){
+		writeEquiv(head, rhs, size, conj);
+		return;
+	}
+	Rule rule;
+	rule.head = head;
+	rule.body.assign(rhs, rhs+size);
+	rule.conj = conj;
+	definitions[definitionid].push_back(rule);
+}
+
+/**
+ * Only rules in a cycle of their definition are written as rules, the others as their completion.
+ * Several rules for one head are first joined: head <- r1 | ... | rn, with ri <- the body of the i-th rule.
+ */
+void InsertWrapper::writeDefinitions(){
+	for(map<int, vector<Rule> >::const_iterator d=definitions.begin(); d!=definitions.end(); ++d){
+		map<int, vector<const Rule*> > byhead;
+		for(vector<Rule>::const_iterator r=(*d).second.begin(); r<(*d).second.end(); ++r){
+			byhead[(*r).head].push_back(&*r);
+		}
+		vector<Rule> rules;
+		for(map<int, vector<const Rule*> >::const_iterator h=byhead.begin(); h!=byhead.end(); ++h){
+			if((*h).second.size()==1){
+				rules.push_back(*(*h).second[0]);
+				continue;
+			}
+			Rule joined;
+			joined.head = (*h).first;
+			joined.conj = false;
+			for(vector<const Rule*>::const_iterator r=(*h).second.begin(); r<(*h).second.end(); ++r){
+				rules.push_back(**r);
+				rules.back().head = createOneShotVar();
+				joined.body.push_back(rules.back().head);
+			}
+			rules.push_back(joined);
+		}
+
+		vector<bool> recursive;
+		getRecursiveRules(rules, recursive);
+		for(unsigned int r=0; r<rules.size(); ++r){
+			if(recursive[r]){
+				writeRule(rules[r].head, rules[r].body, rules[r].conj, (*d).first);
+			}else{
+				writeEquiv(rules[r].head, rules[r].body, rules[r].conj);
+			}
+		}
 	}
-	theory <<" 0\n";
+	definitions.clear();
 }
+
 void InsertWrapper::writeEquiv(int head, const vector<int>& rhs, bool conj){
-	theory <<"Equiv " <<(conj?"C":"D") <<" " <<head <<" ";
-	for(vector<int>::const_iterator i=rhs.begin(); i<rhs.end(); ++i){
-		theory <<*i <<" ";
+	writeEquiv(head, rhs.size()==0?NULL:&rhs[0], rhs.size(), conj);
+}
+void InsertWrapper::writeEquiv(int head, const int* rhs, int size, bool conj){
+	theory.addEquivalence(head, conj, Span<int>(rhs, size));
+}
+
+bool evaluate(COMPARISON op, int value, int value2){
+	switch(op){
+	case COMP_EQ: return value==value2;
+	case COMP_NE: return value!=value2;
+	case COMP_LT: return value<value2;
+	case COMP_LE: return value<=value2;
+	case COMP_GT: return value>value2;
+	default: return value>=value2;
 	}
-	theory <<" 0\n";
 }
 
-template<class T>
-void InsertWrapper::addBinI(const T& boolvar, int intvar, const string& op, int intvar2){
-	theory <<"BINTRI" <<" " <<boolvar <<" " <<intvar <<" " <<op <<" "<<intvar2 <<" 0\n";
+/**
+ * The literals x=v of an integer variable with at most expanddomains values, created on first use together with
+ * their exactly one constraint and their channel to the variable. A constant has the true literal for its value.
+ * Returns false for other expressions.
+ */
+bool InsertWrapper::getValueLits(const Expression& expr, vector<pair<int, int> >& lits){
+	lits.clear();
+	if(expr.type==EXPR_INT){
+		lits.push_back(pair<int, int>(expr.intlit, getTrueLit()));
+		return true;
+	}
+	const MIntVar* var = NULL;
+	if(expr.type==EXPR_IDENT){
+		var = getIntVar(*expr.ident->name);
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		var = getIntVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}else{
+		return false;
+	}
+	if(var->hasvalue){
+		lits.push_back(pair<int, int>(var->mappedvalue, getTrueLit()));
+		return true;
+	}
+	long long size = var->range?(long long)var->end-var->begin+1:var->values.size();
+	if(var->hasmap || size<=0 || size>getTranslationOptions().expanddomains){
+		return false;
+	}
+	map<int, vector<pair<int, int> > >::const_iterator known = valuelits.find(var->var);
+	if(known!=valuelits.end()){
+		lits = (*known).second;
+		return true;
+	}
+
+	vector<int> values;
+	if(var->range){
+		for(int v=var->begin; v<=var->end; ++v){
+			values.push_back(v);
+		}
+	}else{
+		values = var->values;
+		sort(values.begin(), values.end());
+		values.erase(unique(values.begin(), values.end()), values.end());
+	}
+	for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+		lits.push_back(pair<int, int>(*i, createOneShotVar()));
+		theory.addComparison(lits.back().second, var->var, COMP_EQ, *i);
+	}
+	vector<int> atleastone;
+	for(unsigned int i=0; i<lits.size(); ++i){
+		atleastone.push_back(lits[i].second);
+	}
+	theory.addClause(atleastone);
+	for(unsigned int i=0; i<lits.size(); ++i){
+		for(unsigned int j=i+1; j<lits.size(); ++j){
+			theory.addBinary(-lits[i].second, -lits[j].second);
+		}
+	}
+	valuelits[var->var] = lits;
+	return true;
 }
 
-template<class T>
-void InsertWrapper::addBinT(const T& boolvar, int intvar, const string& op, int intvar2){
-	theory <<"BINTRT" <<" " <<boolvar <<" " <<intvar <<" " <<op <<" "<<intvar2 <<" 0\n";
+/**
+ * x op y as clauses over value literals if both are constants or have small domains, with BINTRT otherwise.
+ * With exactly one value, x =< y is the conjunction over v of (x~=v | y>=v), x = y that of (x~=v | y=v) and
+ * (y~=v | x=v). Reified, every such disjunction gets a literal and the head is their conjunction.
+ */
+void InsertWrapper::addIntComparison(const vector<Expression*>& arguments, const int* args, COMPARISON op, bool reif){
+	vector<pair<int, int> > first, second;
+	if(getTranslationOptions().expanddomains==0 || (arguments[0]->type==EXPR_INT && arguments[1]->type==EXPR_INT)
+			|| !getValueLits(*arguments[0], first) || !getValueLits(*arguments[1], second)){
+		theory.addVarComparison(reif?args[2]:getTrue(vars), args[0], op, args[1]);
+		return;
+	}
+
+	bool negated = op==COMP_NE;
+	vector<vector<int> > terms;
+	for(int side=0; side<(op==COMP_LE || op==COMP_LT?1:2); ++side){
+		const vector<pair<int, int> >& lhs = side==0?first:second;
+		const vector<pair<int, int> >& rhs = side==0?second:first;
+		for(vector<pair<int, int> >::const_iterator i=lhs.begin(); i<lhs.end(); ++i){
+			vector<int> term(1, -(*i).second);
+			for(vector<pair<int, int> >::const_iterator j=rhs.begin(); j<rhs.end(); ++j){
+				if(op==COMP_LE?(*j).first>=(*i).first:op==COMP_LT?(*j).first>(*i).first:(*j).first==(*i).first){
+					term.push_back((*j).second);
+				}
+			}
+			terms.push_back(term);
+		}
+	}
+
+	// Leave out the false literal and the terms with the true literal
+	int truelit = getTrueLit();
+	vector<vector<int> > simplified;
+	for(vector<vector<int> >::iterator i=terms.begin(); i<terms.end(); ++i){
+		vector<int> term;
+		bool holds = false;
+		for(vector<int>::const_iterator j=(*i).begin(); j<(*i).end(); ++j){
+			holds |= *j==truelit;
+			if(*j!=-truelit){
+				term.push_back(*j);
+			}
+		}
+		if(!holds){
+			simplified.push_back(term);
+		}
+	}
+
+	if(!reif && !negated){
+		for(vector<vector<int> >::const_iterator i=simplified.begin(); i<simplified.end(); ++i){
+			if((*i).size()==0){
+				theory.addUnit(-truelit);
+			}else{
+				theory.addClause(*i);
+			}
+		}
+		return;
+	}
+	if(!reif){
+		// x~=v | y~=v for every common value
+		for(vector<pair<int, int> >::const_iterator i=first.begin(); i<first.end(); ++i){
+			for(vector<pair<int, int> >::const_iterator j=second.begin(); j<second.end(); ++j){
+				if((*i).first==(*j).first && ((*i).second!=truelit || (*j).second!=truelit)){
+					vector<int> clause;
+					if((*i).second!=truelit){ clause.push_back(-(*i).second); }
+					if((*j).second!=truelit){ clause.push_back(-(*j).second); }
+					theory.addClause(clause);
+				}else if((*i).first==(*j).first){
+					theory.addUnit(-truelit);
+				}
+			}
+		}
+		return;
+	}
+
+	vector<int> holds;
+	bool fails = false;
+	for(vector<vector<int> >::const_iterator i=simplified.begin(); i<simplified.end() && !fails; ++i){
+		if((*i).size()==0){
+			fails = true;
+		}else if((*i).size()==1){
+			holds.push_back((*i)[0]);
+		}else{
+			holds.push_back(createOneShotVar());
+			writeEquiv(holds.back(), *i, false);
+		}
+	}
+	int head = args[2];
+	if(fails || holds.size()==0){
+		theory.addUnit((fails!=negated)?-head:head);
+	}else if(!negated){
+		writeEquiv(head, holds, true);
+	}else{
+		int equal = createOneShotVar();
+		writeEquiv(equal, holds, true);
+		int rhs[] = {-equal};
+		writeEquiv(head, rhs, 1, true);
+	}
+}
+
+//With pbfusion, the constraint is only written when all bool2int channels are known
+void InsertWrapper::addLinear(const string& name, const vector<Expression*>& arguments, const int* args, COMPARISON op, bool reif){
+	LinearConstraint linear;
+	linear.op = op;
+	linear.bound = args[2];
+	linear.head = reif?args[3]:0;
+	vector<int> weights = parseParIntArray(*arguments[0]);
+	if(arguments[1]->type!=EXPR_ARRAY){
+		linear.weights = weights;
+		linear.variables = parseArray(VAR_INT, *arguments[1]);
+	}else if(arguments[1]->arraylit->literals==LITERALS_INT){
+		const vector<int>& values = *arguments[1]->arraylit->values;
+		for(unsigned int i=0; i<values.size() && i<weights.size(); ++i){
+			linear.bound -= weights[i]*values[i];
+		}
+	}else{
+		// Fixed terms move to the bound
+		const vector<Expression*>& exprs = *arguments[1]->arraylit->exprs;
+		for(unsigned int i=0; i<exprs.size() && i<weights.size(); ++i){
+			int value = 0;
+			if(getFixedValue(*exprs[i], false, value)){
+				linear.bound -= weights[i]*value;
+			}else{
+				linear.weights.push_back(weights[i]);
+				linear.variables.push_back(parseInt(*exprs[i]));
+			}
+		}
+	}
+	if(linear.variables.size()==0){
+		bool result = evaluate(op, 0, linear.bound);
+		if(!reif){
+			if(!result){ addFalse(name); }
+		}else{
+			theory.addUnit(result?linear.head:-linear.head);
+		}
+		return;
+	}
+	if(getTranslationOptions().pbfusion){
+		linears.push_back(linear);
+	}else{
+		writeLinear(linear);
+	}
+}
+
+void InsertWrapper::writeLinear(const LinearConstraint& linear){
+	theory.addLinear(linear.head!=0?linear.head:getTrue(vars), linear.variables, linear.weights, linear.op, linear.bound);
+}
+
+/**
+ * A linear constraint over bool2int channels as a cardinality or weighted sum over the booleans.
+ * Negative weights are moved to the negated boolean: w*b = w + -w*(not b).
+ */
+void InsertWrapper::writePseudoBoolean(const LinearConstraint& linear){
+	vector<int> lits, weights;
+	int bound = linear.bound;
+	bool card = true;
+	for(unsigned int i=0; i<linear.variables.size(); ++i){
+		int lit = channels[linear.variables[i]];
+		int weight = linear.weights[i];
+		if(weight==0){
+			continue;
+		}
+		if(weight<0){
+			lit = -lit;
+			bound -= weight;
+			weight = -weight;
+		}
+		lits.push_back(lit);
+		weights.push_back(weight);
+		card &= weight==1;
+	}
+
+	int setid = nextsetid++;
+	theory.addSet(setid, lits, card?Span<int>():Span<int>(weights));
+
+	AGGREGATE aggregate = card?AGG_CARD:AGG_SUM;
+	if(linear.op==COMP_LE){
+		theory.addAggregate(aggregate, linear.head!=0?linear.head:getTrueLit(), setid, true, bound);
+		return;
+	}
+	if(linear.op==COMP_EQ && linear.head==0){
+		theory.addAggregate(aggregate, getTrueLit(), setid, true, bound);
+		theory.addAggregate(aggregate, getTrueLit(), setid, false, bound);
+		return;
+	}
+	int both[] = {createOneShotVar(), createOneShotVar()};
+	theory.addAggregate(aggregate, both[0], setid, true, bound);
+	theory.addAggregate(aggregate, both[1], setid, false, bound);
+	if(linear.op==COMP_EQ){
+		writeEquiv(linear.head, both, 2, true);
+		return;
+	}
+	int equal = createOneShotVar();
+	writeEquiv(equal, both, 2, true);
+	if(linear.head==0){
+		theory.addUnit(-equal);
+		return;
+	}
+	theory.addBinary(-linear.head, -equal);
+	theory.addBinary(linear.head, equal);
 }
 
-template<class T>
-T getRevArg(const vector<T>& list, int index){
-	return list[list.size()-index-1];
+/**
+ * Writes the linear constraints over only bool2int channels as aggregates and the others as before.
+ * A channel whose integer variable has 0 and 1 in its domain and is used nowhere else is left out entirely.
+ */
+void InsertWrapper::fuseLinears(){
+	if(linears.size()==0 && channels.size()==0){
+		return;
+	}
+	int maxvar = getMaxVar();
+	vector<int> uses(maxvar+1, 0);
+	vector<bool> booleandomain(maxvar+1, false);
+	const StatementBuffer* buffers[] = {&vars, &theory};
+	for(int b=0; b<2; ++b){
+		const StatementBuffer& buffer = *buffers[b];
+		for(unsigned int s=0; s<buffer.size(); s=buffer.next(s)){
+			const int* variables = buffer.getVars(s);
+			for(const int* i=variables; i<variables+buffer.getNbVars(s); ++i){
+				uses[abs(*i)]++;
+			}
+			STATEMENT type = buffer.getType(s);
+			if((type!=ECNF_INTVAR && type!=ECNF_INTVARDOM) || channels.find(variables[0])==channels.end()){
+				continue;
+			}
+			const int* values = buffer.getConstants(s);
+			if(type==ECNF_INTVAR){
+				booleandomain[variables[0]] = values[0]<=0 && values[1]>=1;
+			}else{
+				bool zero = false, one = false;
+				for(const int* i=values; i<values+buffer.getNbConstants(s); ++i){
+					zero |= *i==0;
+					one |= *i==1;
+				}
+				booleandomain[variables[0]] = zero && one;
+			}
+		}
+	}
+	const vector<OutputVariable>& outputs = getOutputVariables();
+	for(vector<OutputVariable>::const_iterator i=outputs.begin(); i<outputs.end(); ++i){
+		for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			if((*j).type==MAP_INT){
+				uses[(*j).value]++;
+			}
+		}
+	}
+
+	const vector<SearchHint>& hints = getSearchHints();
+	for(vector<SearchHint>::const_iterator i=hints.begin(); i<hints.end(); ++i){
+		for(vector<int>::const_iterator j=(*i).vars.begin(); j<(*i).vars.end() && !(*i).booleans; ++j){
+			uses[*j]++;
+		}
+	}
+
+	vector<bool> fused(linears.size(), true);
+	for(unsigned int l=0; l<linears.size(); ++l){
+		const vector<int>& variables = linears[l].variables;
+		for(vector<int>::const_iterator i=variables.begin(); i<variables.end() && fused[l]; ++i){
+			fused[l] = channels.find(*i)!=channels.end();
+		}
+		if(!fused[l]){
+			for(vector<int>::const_iterator i=variables.begin(); i<variables.end(); ++i){
+				uses[*i]++;
+			}
+		}
+	}
+	for(unsigned int l=0; l<linears.size(); ++l){
+		if(fused[l]){
+			writePseudoBoolean(linears[l]);
+		}else{
+			writeLinear(linears[l]);
+		}
+	}
+	linears.clear();
+
+	// Only its declaration uses the integer variable
+	vector<bool> removed(maxvar+1, false);
+	bool anyremoved = false;
+	for(map<int, int>::const_iterator i=channels.begin(); i!=channels.end(); ++i){
+		if(uses[(*i).first]<=1 && booleandomain[(*i).first]){
+			removed[(*i).first] = true;
+			anyremoved = true;
+		}else{
+			theory.addComparison((*i).second, (*i).first, COMP_EQ, 1);
+		}
+	}
+	channels.clear();
+	if(!anyremoved){
+		return;
+	}
+
+	// Aggregates may have added true heads
+	StatementBuffer kept;
+	for(unsigned int s=0; s<vars.size(); s=vars.next(s)){
+		STATEMENT type = vars.getType(s);
+		if((type!=ECNF_INTVAR && type!=ECNF_INTVARDOM) || !removed[vars.getVars(s)[0]]){
+			kept.addStatement(vars, s);
+		}
+	}
+	vars.swap(kept);
 }
 
-void InsertWrapper::addLinear(const vector<Expression*>& arguments, const string& op, bool reif){
-	if(arguments.size()!=(reif?4:3)){ throw fzexception("Incorrect number of arguments.\n"); }
-	vector<int> weights = parseParIntArray(*getRevArg(arguments, 0));
-	vector<int> variables = parseArray(VAR_INT, *getRevArg(arguments, 1));
-	int intvar = parseParInt(*getRevArg(arguments, 2));
-	theory <<"SUMSTSIRI ";
+enum POLARITY { POLARITY_NONE = 0, POLARITY_POSITIVE = 1, POLARITY_NEGATIVE = 2, POLARITY_BOTH = 3 };
+
+/**
+ * Half-reification: an Equiv whose head occurs only positively in the other statements becomes head => body, one whose
+ * head occurs only negatively body => head, both as clauses, and one whose head occurs nowhere else is left out.
+ * Clauses give their literals one polarity, all other statements both. The body of an Equiv gets the polarity of what
+ * the Equiv becomes, so the analysis runs until no polarity grows. Output and search variables keep their equivalence.
+ */
+void InsertWrapper::halfReify(){
+	int maxvar = getMaxVar();
+	vector<char> polarity(maxvar+1, POLARITY_NONE);
+	vector<int> definitions(maxvar+1, 0);	// The number of Equivs with the variable as head
+	vector<int> equivstart(1, 0), equivlits;	// The head and body of each Equiv of the theory
+	vector<bool> conjunctive;
+	const StatementBuffer* buffers[] = {&vars, &theory};
+	for(int b=0; b<2; ++b){
+		const StatementBuffer& buffer = *buffers[b];
+		for(unsigned int s=0; s<buffer.size(); s=buffer.next(s)){
+			const int* variables = buffer.getVars(s);
+			unsigned int nbvars = buffer.getNbVars(s);
+			if(b==1 && buffer.getType(s)==ECNF_EQUIV){
+				equivlits.insert(equivlits.end(), variables, variables+nbvars);
+				equivstart.push_back(equivlits.size());
+				conjunctive.push_back(buffer.getConstants(s)[0]!=0);
+				definitions[abs(variables[0])]++;
+			}else{
+				bool clause = buffer.getType(s)==ECNF_CLAUSE;
+				for(const int* i=variables; i<variables+nbvars; ++i){
+					polarity[abs(*i)] |= !clause?POLARITY_BOTH:*i>0?POLARITY_POSITIVE:POLARITY_NEGATIVE;
+				}
+			}
+		}
+	}
+	if(conjunctive.size()==0){
+		return;
+	}
+
+	const vector<OutputVariable>& outputs = getOutputVariables();
+	for(vector<OutputVariable>::const_iterator i=outputs.begin(); i<outputs.end(); ++i){
+		for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			if((*j).type==MAP_BOOL){
+				polarity[abs((*j).value)] = POLARITY_BOTH;
+			}
+		}
+	}
+	const vector<SearchHint>& hints = getSearchHints();
+	for(vector<SearchHint>::const_iterator i=hints.begin(); i<hints.end(); ++i){
+		for(vector<int>::const_iterator j=(*i).vars.begin(); j<(*i).vars.end() && (*i).booleans; ++j){
+			polarity[abs(*j)] = POLARITY_BOTH;
+		}
+	}
+
+	// A head of several Equivs occurs in the others
+	int nbequivs = conjunctive.size();
+	vector<int> definition(maxvar+1, -1);
+	for(int e=0; e<nbequivs; ++e){
+		int head = abs(equivlits[equivstart[e]]);
+		if(definitions[head]>1){
+			polarity[head] = POLARITY_BOTH;
+		}
+		definition[head] = e;
+	}
+	vector<int> queue;
+	vector<bool> queued(nbequivs, true);
+	for(int e=nbequivs-1; e>=0; --e){
+		queue.push_back(e);
+	}
+	while(queue.size()>0){
+		int e = queue.back();
+		queue.pop_back();
+		queued[e] = false;
+		int head = equivlits[equivstart[e]];
+		char headpolarity = polarity[abs(head)];
+		if(head<0 && headpolarity!=POLARITY_BOTH && headpolarity!=POLARITY_NONE){
+			headpolarity ^= POLARITY_BOTH;
+		}
+		for(int i=equivstart[e]+1; i<equivstart[e+1]; ++i){
+			int lit = equivlits[i];
+			char added = headpolarity;
+			if(lit<0 && added!=POLARITY_BOTH && added!=POLARITY_NONE){
+				added ^= POLARITY_BOTH;
+			}
+			char& current = polarity[abs(lit)];
+			if((current|added)==current){
+				continue;
+			}
+			current |= added;
+			int next = definition[abs(lit)];
+			if(next>=0 && !queued[next]){
+				queued[next] = true;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	StatementBuffer result;
+	int e = 0;
+	for(unsigned int s=0; s<theory.size(); s=theory.next(s)){
+		if(theory.getType(s)!=ECNF_EQUIV){
+			result.addStatement(theory, s);
+			continue;
+		}
+		int head = equivlits[equivstart[e]];
+		char headpolarity = polarity[abs(head)];
+		if(head<0 && headpolarity!=POLARITY_BOTH && headpolarity!=POLARITY_NONE){
+			headpolarity ^= POLARITY_BOTH;
+		}
+		if(headpolarity==POLARITY_BOTH){
+			result.addStatement(theory, s);
+		}else if(headpolarity!=POLARITY_NONE){
+			bool positive = headpolarity==POLARITY_POSITIVE;
+			// head => body is a clause per conjunct or one clause for a disjunction, body => head the other way around
+			if(conjunctive[e]==positive){
+				for(int i=equivstart[e]+1; i<equivstart[e+1]; ++i){
+					result.addBinary(positive?-head:head, positive?equivlits[i]:-equivlits[i]);
+				}
+			}else{
+				vector<int> clause(1, positive?-head:head);
+				for(int i=equivstart[e]+1; i<equivstart[e+1]; ++i){
+					clause.push_back(positive?equivlits[i]:-equivlits[i]);
+				}
+				result.addClause(clause);
+			}
+		}
+		++e;
+	}
+	theory.swap(result);
+}
+
+/**
+ * Support encoding of table_int/table_bool: every tuple gets a selector literal, at least one selector is true,
+ * a selector implies each of its value literals and each value literal implies one of the selectors supporting it.
+ * The tuples are kept as one flat buffer of nbvars*nbtuples values.
+ */
+void InsertWrapper::addTable(const vector<Expression*>& arguments, bool booltable){
+	vector<int> variables = parseArray(booltable?VAR_BOOL:VAR_INT, *arguments[0]);
+	vector<int> tuples = booltable?parseParBoolArray(*arguments[1]):parseParIntArray(*arguments[1]);
+
+	unsigned int arity = variables.size();
+	if(arity==0){ return; }
+	if(tuples.size()%arity!=0){ throw fzexception("Table size is not a multiple of the number of variables.\n"); }
+	unsigned int nbtuples = tuples.size()/arity;
+
+	if(nbtuples==0){
+		theory.addUnit(-getTrue(vars));
+		return;
+	}
+
+	map<pair<int, int>, int> value2lit;		// (variable, value) to the literal var = value
+	map<int, vector<int> > supports;		// value literal to the selectors of the tuples containing it
+	vector<int> selectors;
+	selectors.reserve(nbtuples);
+	for(unsigned int t=0; t<nbtuples; ++t){
+		int selector = createOneShotVar();
+		selectors.push_back(selector);
+		const int* tuple = &tuples[t*arity];
+		for(unsigned int i=0; i<arity; ++i){
+			int lit;
+			if(booltable){
+				lit = tuple[i]==1?variables[i]:-variables[i];
+			}else{
+				pair<int, int> key(variables[i], tuple[i]);
+				map<pair<int, int>, int>::const_iterator it = value2lit.find(key);
+				if(it==value2lit.end()){
+					lit = createOneShotVar();
+					theory.addComparison(lit, variables[i], COMP_EQ, tuple[i]);
+					value2lit.insert(pair<pair<int, int>, int>(key, lit));
+				}else{
+					lit = (*it).second;
+				}
+			}
+			theory.addBinary(-selector, lit);
+			supports[lit].push_back(selector);
+		}
+	}
+
+	theory.addClause(selectors);
+
+	for(map<int, vector<int> >::const_iterator i=supports.begin(); i!=supports.end(); ++i){
+		vector<int> clause(1, -(*i).first);
+		clause.insert(clause.end(), (*i).second.begin(), (*i).second.end());
+		theory.addClause(clause);
+	}
+}
+
+int InsertWrapper::getTrueLit(){
+	if(truelit==0){
+		truelit = getTrue(vars);
+	}
+	return truelit;
+}
+
+//Unlike -getTrueLit(), can be the head of a statement
+int InsertWrapper::getFalseLit(){
+	if(falselit==0){
+		falselit = getFalse(vars);
+	}
+	return falselit;
+}
+
+//Constants and variables with a known value, booleans are 1 or 0
+bool InsertWrapper::getFixedValue(const Expression& expr, bool boolean, int& value){
+	if(expr.type==EXPR_BOOL){
+		value = expr.boollit?1:0;
+		return true;
+	}else if(expr.type==EXPR_INT){
+		value = expr.intlit;
+		return true;
+	}else if(expr.type==EXPR_IDENT && boolean){
+		const MBoolVar& var = *getBoolVar(*expr.ident->name);
+		value = var.mappedvalue?1:0;
+		return var.hasvalue;
+	}else if(expr.type==EXPR_IDENT){
+		const MIntVar& var = *getIntVar(*expr.ident->name);
+		value = var.mappedvalue;
+		return var.hasvalue;
+	}else if(expr.type==EXPR_ARRAYACCESS && boolean){
+		const MBoolVar& var = *getBoolVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+		value = var.mappedvalue?1:0;
+		return var.hasvalue;
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		const MIntVar& var = *getIntVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+		value = var.mappedvalue;
+		return var.hasvalue;
+	}
+	return false;
+}
+
+//The model is unsatisfiable whatever the other constraints, so those are skipped
+void InsertWrapper::addFalse(const string& constraint){
+	if(!unsatisfiable){
+		cerr <<"Constraint " <<constraint <<" is false, the model is unsatisfiable.\n";
+		theory.addUnit(-getTrueLit());
+	}
+	unsatisfiable = true;
+}
+
+/**
+ * Constraints that are known to hold or fail, or that can be written with a constant instead of a fixed variable.
+ * Returns false if the constraint still has to be added.
+ */
+bool InsertWrapper::addFixed(const string& name, CONSTRAINT_TYPE type, const vector<Expression*>& arguments){
+	switch(type){
+	case inteq: case inteqr: case intle: case intler: case intlt: case intltr: case intne: case intner:{
+		COMPARISON op = type==inteq || type==inteqr?COMP_EQ:type==intle || type==intler?COMP_LE:type==intlt || type==intltr?COMP_LT:COMP_NE;
+		bool reif = type==inteqr || type==intler || type==intltr || type==intner;
+		int value = 0, value2 = 0, holds = 0;
+		bool fixed = getFixedValue(*arguments[0], false, value);
+		bool fixed2 = getFixedValue(*arguments[1], false, value2);
+		if(fixed && fixed2){
+			bool result = evaluate(op, value, value2);
+			if(!reif){
+				if(!result){ addFalse(name); }
+			}else if(getFixedValue(*arguments[2], true, holds)){
+				if(result!=(holds==1)){ addFalse(name); }
+			}else{
+				int head = parseBool(*arguments[2]);
+				theory.addUnit(result?head:-head);
+			}
+			return true;
+		}
+		if(!fixed && !fixed2){
+			return false;
+		}
+		int args[] = {0, 0, reif?parseBool(*arguments[2]):getTrueLit()};
+		vector<pair<int, int> > lits;
+		if(getTranslationOptions().expanddomains>0 && getValueLits(*arguments[fixed?1:0], lits)){
+			addIntComparison(arguments, args, op, reif);
+			return true;
+		}
+		// c op x is x op' c
+		COMPARISON flipped = op;
+		if(fixed && flipped==COMP_LE){
+			flipped = COMP_GE;
+		}else if(fixed && flipped==COMP_LT){
+			flipped = COMP_GT;
+		}
+		theory.addComparison(args[2], parseInt(*arguments[fixed?1:0]), flipped, fixed?value:value2);
+		return true;}
+	case booleq: case boolnot:{
+		int value = 0, value2 = 0;
+		bool fixed = getFixedValue(*arguments[0], true, value);
+		bool fixed2 = getFixedValue(*arguments[1], true, value2);
+		if(type==boolnot){
+			value = 1-value;
+		}
+		if(fixed && fixed2){
+			if(value!=value2){ addFalse(name); }
+		}else if(fixed){
+			int lit = parseBool(*arguments[1]);
+			theory.addUnit(value==1?lit:-lit);
+		}else if(fixed2){
+			int lit = parseBool(*arguments[0]);
+			theory.addUnit((value2==1)!=(type==boolnot)?lit:-lit);
+		}
+		return fixed || fixed2;}
+	case booland: case boolor: case booleqr: case booller: case boolltr: case boolxor:{
+		int value = 0, value2 = 0, holds = 0;
+		if(!getFixedValue(*arguments[0], true, value) || !getFixedValue(*arguments[1], true, value2)){
+			return false;
+		}
+		bool result = type==booland?value && value2:type==boolor?value || value2:type==booleqr?value==value2
+				:type==booller?value<=value2:type==boolltr?value<value2:value!=value2;
+		if(getFixedValue(*arguments[2], true, holds)){
+			if(result!=(holds==1)){ addFalse(name); }
+		}else{
+			int head = parseBool(*arguments[2]);
+			theory.addUnit(result?head:-head);
+		}
+		return true;}
+	case boolclause:{
+		if(arguments[0]->type!=EXPR_ARRAY || arguments[1]->type!=EXPR_ARRAY){
+			return false;
+		}
+		vector<int> clause;
+		for(int sign=0; sign<2; ++sign){
+			const ArrayLiteral& array = *arguments[sign]->arraylit;
+			if(array.literals!=LITERALS_NONE){
+				for(vector<int>::const_iterator i=array.values->begin(); i<array.values->end(); ++i){
+					if((*i!=0)==(sign==0)){ return true; }
+				}
+				continue;
+			}
+			for(vector<Expression*>::const_iterator i=array.exprs->begin(); i<array.exprs->end(); ++i){
+				int value;
+				if(!getFixedValue(**i, true, value)){
+					clause.push_back(sign==0?parseBool(**i):-parseBool(**i));
+				}else if((value==1)==(sign==0)){
+					return true;
+				}
+			}
+		}
+		if(clause.size()==0){
+			addFalse(name);
+			return true;
+		}
+		theory.addClause(clause);
+		return true;}
+	default:
+		return false;
+	}
+}
+
+//Values outside the universe of the set get the false literal
+int InsertWrapper::getMember(const MSetVar& set, int value){
+	if(set.hasvalue){
+		return set.value.contains(value)?getTrueLit():-getTrueLit();
+	}
+	int lit = getMembershipLit(set, value);
+	return lit==0?-getTrueLit():lit;
+}
+
+//Returns a new literal which is true iff both literals have the same value
+int InsertWrapper::getEqualLit(int lit, int lit2){
+	vector<int> bothtrue; bothtrue.push_back(lit); bothtrue.push_back(lit2);
+	vector<int> bothfalse; bothfalse.push_back(-lit); bothfalse.push_back(-lit2);
+	int bothtruereif = createOneShotVar();
+	int bothfalsereif = createOneShotVar();
+	writeEquiv(bothtruereif, bothtrue, true);
+	writeEquiv(bothfalsereif, bothfalse, true);
+	int equal = createOneShotVar();
+	vector<int> oneofboth; oneofboth.push_back(bothtruereif); oneofboth.push_back(bothfalsereif);
+	writeEquiv(equal, oneofboth, false);
+	return equal;
+}
+
+//As writeEquiv, but the head can be the false literal
+void InsertWrapper::writeSetEquiv(int head, const vector<int>& body, bool conj){
+	if(head>0){
+		writeEquiv(head, body, conj);
+	}else if(conj){
+		vector<int> clause;
+		for(vector<int>::const_iterator i=body.begin(); i<body.end(); ++i){
+			clause.push_back(-*i);
+		}
+		theory.addClause(clause);
+	}else{
+		for(vector<int>::const_iterator i=body.begin(); i<body.end(); ++i){
+			theory.addUnit(-*i);
+		}
+	}
+}
+
+void sortUnique(vector<int>& values){
+	sort(values.begin(), values.end());
+	values.erase(unique(values.begin(), values.end()), values.end());
+}
+
+/**
+ * Adds, in increasing order, the values for which a relation over the sets has to be written: the universes of the set
+ * variables and the values of the enumerated constant sets. The other values of the constant ranges lie in stretches
+ * between the bounds of the ranges, in which every value is in the same sets, so only the first value of each is added.
+ */
+void addUniverse(const vector<const MSetVar*>& sets, vector<int>& values){
+	vector<long long> starts;
+	for(vector<const MSetVar*>::const_iterator i=sets.begin(); i<sets.end(); ++i){
+		const MSetVar& set = **i;
+		if(!set.hasvalue){
+			for(unsigned int j=0; j<set.lits.size(); ++j){
+				if(set.lits[j]!=0){
+					values.push_back(set.offset+j);
+				}
+			}
+			continue;
+		}
+		const vector<pair<int, int> >& ranges = set.value.getRanges();
+		if(ranges.size()==0){
+			set.value.getValues(values);
+		}
+		for(vector<pair<int, int> >::const_iterator j=ranges.begin(); j<ranges.end(); ++j){
+			starts.push_back((*j).first);
+			starts.push_back((long long)(*j).second+1);
+		}
+	}
+	sortUnique(values);
+	vector<int> firsts;
+	for(vector<long long>::const_iterator i=starts.begin(); i<starts.end(); ++i){
+		long long value = *i;
+		for(vector<int>::const_iterator j=lower_bound(values.begin(), values.end(), value); j<values.end() && *j==value; ++j){
+			++value;
+		}
+		bool member = false;
+		for(vector<const MSetVar*>::const_iterator j=sets.begin(); j<sets.end() && value<=INT_MAX && !member; ++j){
+			member = (*j)->hasvalue && (*j)->value.contains(value);
+		}
+		if(member){
+			firsts.push_back(value);
+		}
+	}
+	values.insert(values.end(), firsts.begin(), firsts.end());
+	sortUnique(values);
+}
+
+//The values of a constant set which the integer argument can take, in increasing order
+void getDomainValues(const Expression& expr, const IntBitset& set, vector<int>& values){
+	const MIntVar* domain;
+	if(expr.type==EXPR_INT){
+		if(set.contains(expr.intlit)){
+			values.push_back(expr.intlit);
+		}
+		return;
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		domain = getIntVar(*expr.arrayaccesslit->id, expr.arrayaccesslit->index);
+	}else if(expr.type==EXPR_IDENT){
+		domain = getIntVar(*expr.ident->name);
+	}else{ throw fzexception("Unexpected type.\n"); }
+
+	if(!domain->range){
+		for(vector<int>::const_iterator i=domain->values.begin(); i<domain->values.end(); ++i){
+			if(set.contains(*i)){
+				values.push_back(*i);
+			}
+		}
+		sortUnique(values);
+		return;
+	}
+	// Ranges are cut to the domain, so only the values of the integer are listed
+	const vector<pair<int, int> >& ranges = set.getRanges();
+	if(ranges.size()>0){
+		for(vector<pair<int, int> >::const_iterator i=ranges.begin(); i<ranges.end(); ++i){
+			for(long long value=max((*i).first, domain->begin); value<=min((*i).second, domain->end); ++value){
+				values.push_back(value);
+			}
+		}
+		return;
+	}
+	vector<int> setvalues;
+	set.getValues(setvalues);
+	vector<int>::const_iterator begin = lower_bound(setvalues.begin(), setvalues.end(), domain->begin);
+	vector<int>::const_iterator end = upper_bound(setvalues.begin(), setvalues.end(), domain->end);
+	values.insert(values.end(), begin, end);
+}
+
+void InsertWrapper::addSetIn(const vector<Expression*>& arguments, const int* args, bool reif){
+	int intvar = args[0];
+	MSetVar set;
+	parseSet(*arguments[1], set);
+
+	// Constant ranges only need their bounds, several ranges are a disjunction of one literal per range
+	vector<int> members;
+	const vector<pair<int, int> >& ranges = set.value.getRanges();
+	for(vector<pair<int, int> >::const_iterator i=ranges.begin(); i<ranges.end(); ++i){
+		int belowmax = createOneShotVar();
+		int belowmin = createOneShotVar();
+		theory.addComparison(belowmax, intvar, COMP_LE, (*i).second);
+		theory.addComparison(belowmin, intvar, COMP_LT, (*i).first);
+		vector<int> inrange; inrange.push_back(belowmax); inrange.push_back(-belowmin);
+		if(ranges.size()>1){
+			int member = createOneShotVar();
+			writeEquiv(member, inrange, true);
+			members.push_back(member);
+		}else if(reif){
+			writeEquiv(args[2], inrange, true);
+		}else{
+			theory.addUnit(belowmax);
+			theory.addUnit(-belowmin);
+		}
+	}
+	if(ranges.size()==1){
+		return;
+	}
+
+	if(set.hasvalue && ranges.size()==0){
+		vector<int> values;
+		getDomainValues(*arguments[0], set.value, values);
+		for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+			int equal = createOneShotVar();
+			theory.addComparison(equal, intvar, COMP_EQ, *i);
+			members.push_back(equal);
+		}
+	}
+	for(unsigned int i=0; i<set.lits.size(); ++i){
+		int member = set.lits[i];
+		if(member==0){
+			continue;
+		}
+		int equal = createOneShotVar();
+		theory.addComparison(equal, intvar, COMP_EQ, set.offset+i);
+		if(reif){
+			int both = createOneShotVar();
+			vector<int> rhs; rhs.push_back(equal); rhs.push_back(member);
+			writeEquiv(both, rhs, true);
+			members.push_back(both);
+		}else{
+			theory.addBinary(-equal, member);
+			members.push_back(equal);
+		}
+	}
+	if(members.size()==0){
+		members.push_back(-getTrueLit());
+	}
 	if(reif){
-		theory <<parseBool(*getRevArg(arguments, 3)) <<" ";
+		writeEquiv(args[2], members, false);
 	}else{
-		theory <<getTrue(vars) <<" ";
+		theory.addClause(members);
 	}
-	for(unsigned int i=0; i<variables.size(); ++i){
-		theory <<variables[i] <<" ";
+}
+
+//The membership literals are channeled into 0..1 integers which are summed
+void InsertWrapper::addSetCard(const vector<Expression*>& arguments, const int* args){
+	MSetVar set;
+	parseSet(*arguments[0], set);
+	int card = args[1];
+
+	long long fixedmembers = set.hasvalue?set.value.size():0;
+	if(fixedmembers>INT_MAX){
+		throw fzexception("The cardinality of a constant set is too large.\n");
 	}
-	theory <<" | ";
-	for(unsigned int i=0; i<weights.size(); ++i){
-		theory <<weights[i] <<" ";
+	vector<int> members;
+	for(vector<int>::const_iterator i=set.lits.begin(); i<set.lits.end(); ++i){
+		if(*i==0){
+			continue;
+		}
+		int member = createOneShotVar();
+		vars.addIntVar(member, 0, 1);
+		theory.addComparison(*i, member, COMP_EQ, 1);
+		members.push_back(member);
 	}
-	theory <<" " <<op <<" " <<intvar <<" 0\n";
+	vector<int> weights(members.size(), 1);
+	members.push_back(card);
+	weights.push_back(-1);
+	theory.addLinear(getTrue(vars), members, weights, COMP_EQ, -fixedmembers);
 }
 
-//VERY IMPORTANT: ALL PARSED VECTORS ARE REVERSED ORDER (TO HAVE FASTER PARSING)!!!!
-void InsertWrapper::add(Constraint* var){
-	const vector<Expression*>& arguments = *var->id->arguments;
-	vector<int> args;
-	vector<ARG_TYPE> types;
+//set_eq, set_ne, set_subset and their reifications
+void InsertWrapper::addSetRelation(const vector<Expression*>& arguments, const int* args, CONSTRAINT_TYPE type){
+	bool reif = type==seteqr || type==setner || type==setsubsetr;
+	MSetVar first, second;
+	parseSet(*arguments[0], first);
+	parseSet(*arguments[1], second);
 
-	map<string, CONSTRAINT_TYPE>::const_iterator it = name2type.find(*var->id->name);
+	vector<const MSetVar*> sets;
+	sets.push_back(&first);
+	sets.push_back(&second);
+	vector<int> values;
+	addUniverse(sets, values);
+
+	vector<int> holds; // Per value, a literal which is true iff the relation holds for that value
+	for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+		bool outside = first.hasvalue?!first.value.contains(*i):getMembershipLit(first, *i)==0;
+		if(outside && (type==setsubset || type==setsubsetr)){
+			continue;	// The subset relation holds for values outside the first set
+		}
+		int lit = getMember(first, *i), lit2 = getMember(second, *i);
+		switch(type){
+		case seteq:
+			theory.addBinary(-lit, lit2);
+			theory.addBinary(lit, -lit2);
+			break;
+		case setsubset:
+			theory.addBinary(-lit, lit2);
+			break;
+		case setne:{
+			int differ = createOneShotVar();
+			int both[] = {-differ, lit, lit2};
+			int neither[] = {-differ, -lit, -lit2};
+			theory.addClause(Span<int>(both, 3));
+			theory.addClause(Span<int>(neither, 3));
+			holds.push_back(differ);
+			break;}
+		case setsubsetr:{
+			int subset = createOneShotVar();
+			vector<int> rhs; rhs.push_back(-lit); rhs.push_back(lit2);
+			writeEquiv(subset, rhs, false);
+			holds.push_back(subset);
+			break;}
+		case setner:
+			holds.push_back(-getEqualLit(lit, lit2));
+			break;
+		default:
+			holds.push_back(getEqualLit(lit, lit2));
+			break;
+		}
+	}
+
+	if(type==setne){
+		if(holds.size()==0){
+			holds.push_back(-getTrueLit());
+		}
+		theory.addClause(holds);
+	}else if(reif){
+		bool conj = type!=setner;
+		if(holds.size()==0){
+			holds.push_back(conj?getTrueLit():-getTrueLit());
+		}
+		writeEquiv(args[2], holds, conj);
+	}
+}
+
+//set_union, set_intersect, set_diff and set_symdiff
+void InsertWrapper::addSetOperation(const vector<Expression*>& arguments, CONSTRAINT_TYPE type){
+	MSetVar first, second, result;
+	parseSet(*arguments[0], first);
+	parseSet(*arguments[1], second);
+	parseSet(*arguments[2], result);
+
+	vector<const MSetVar*> sets;
+	sets.push_back(&first);
+	sets.push_back(&second);
+	sets.push_back(&result);
+	vector<int> values;
+	addUniverse(sets, values);
+
+	for(vector<int>::const_iterator i=values.begin(); i<values.end(); ++i){
+		int lit = getMember(first, *i), lit2 = getMember(second, *i);
+		vector<int> rhs;
+		bool conj = true;
+		switch(type){
+		case setunion:
+			rhs.push_back(lit); rhs.push_back(lit2);
+			conj = false;
+			break;
+		case setintersect:
+			rhs.push_back(lit); rhs.push_back(lit2);
+			break;
+		case setdiff:
+			rhs.push_back(lit); rhs.push_back(-lit2);
+			break;
+		default:{
+			vector<int> firstonly; firstonly.push_back(lit); firstonly.push_back(-lit2);
+			vector<int> secondonly; secondonly.push_back(-lit); secondonly.push_back(lit2);
+			int firstonlyreif = createOneShotVar();
+			int secondonlyreif = createOneShotVar();
+			writeEquiv(firstonlyreif, firstonly, true);
+			writeEquiv(secondonlyreif, secondonly, true);
+			rhs.push_back(firstonlyreif); rhs.push_back(secondonlyreif);
+			conj = false;
+			break;}
+		}
+		writeSetEquiv(getMember(result, *i), rhs, conj);
+	}
+}
 
-	if(it==name2type.end()){
+void InsertWrapper::add(Constraint* var){
+	if(var->type<0){
 		stringstream ss;
 		ss <<"Constraint " <<*var->id->name <<" is not a supported constraint.\n";
 		throw fzexception(ss.str());
 	}
 
-	switch ((*it).second) {
+	MemoryScope output(MEM_OUTPUT);
+	Statistics& stats = getStatistics();
+	double start = stats.enabled?currentTime():0;
+
+	const vector<Expression*>& arguments = *var->id->arguments;
+	const ConstraintSignature& signature = getSignature((CONSTRAINT_TYPE)var->type);
+	definitionid = defaultdefID;
+	defining = var->annotations!=NULL && hasDefinitionAnnotation(*var->annotations, definitionid);
+	if(defining && signature.type!=booland && signature.type!=boolor && signature.type!=arraybooland
+			&& signature.type!=arrayboolor && signature.type!=booleq && signature.type!=boolnot){
+		stringstream ss;
+		ss <<"Constraint " <<*var->id->name <<" cannot be part of an inductive definition.\n";
+		throw fzexception(ss.str());
+	}
+
+	if(unsatisfiable || (!defining && addFixed(*var->id->name, signature.type, arguments))){
+		if(stats.enabled){
+			double time = currentTime()-start;
+			stats.addConstraint(signature.type, time);
+			stats.phasetime[PHASE_CONSTRAINTS] += time;
+		}
+		return;
+	}
+
+	int args[MAXCONSTRAINTARGS];
+	parseArgs(arguments, args, signature);
+
+	switch (signature.type) {
 	case bool2int:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
-		addBinI(args[0], args[1], "=", 1);
+		if(!getTranslationOptions().pbfusion || !channels.insert(pair<int, int>(args[1], args[0])).second){
+			theory.addComparison(args[0], args[1], COMP_EQ, 1);
+		}
 		break;}
 	case booland:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> rhs;
-		rhs.push_back(args[0]);
-		rhs.push_back(args[1]);
-		writeEquiv(args[2], rhs, true);
+		int rhs[] = {args[0], args[1]};
+		writeRuleOrEquiv(args[2], rhs, 2, true);
 		break;}
 	case boolclause:{
-		if(arguments.size()!=2){ throw fzexception("Incorrect number of arguments.\n"); }
-		vector<int> arg1 = parseArray(VAR_BOOL, *getRevArg(arguments, 0));
-		vector<int> arg2 = parseArray(VAR_BOOL, *getRevArg(arguments, 1));
-		for(vector<int>::const_iterator i=arg1.begin(); i<arg1.end(); ++i){
-			theory <<*i <<" ";
-		}
+		vector<int> arg1 = parseArray(VAR_BOOL, *arguments[0]);
+		vector<int> arg2 = parseArray(VAR_BOOL, *arguments[1]);
 		for(vector<int>::const_iterator i=arg2.begin(); i<arg2.end(); ++i){
-			theory <<"-" <<*i <<" ";
+			arg1.push_back(-*i);
 		}
-		theory <<" 0\n";
+		theory.addClause(arg1);
 		break;}
 	case arraybooland:{
-		if(arguments.size()!=2){ throw fzexception("Incorrect number of arguments.\n"); }
-		vector<int> arg1 = parseArray(VAR_BOOL, *getRevArg(arguments, 0));
-		int arg2 = parseBool(*getRevArg(arguments, 1));
-		writeEquiv(arg2, arg1, true);
+		vector<int> arg1 = parseArray(VAR_BOOL, *arguments[0]);
+		writeRuleOrEquiv(args[1], arg1.size()==0?NULL:&arg1[0], arg1.size(), true);
 		break;}
 	case arrayboolor:{
-		if(arguments.size()!=2){ throw fzexception("Incorrect number of arguments.\n"); }
-		vector<int> arg1 = parseArray(VAR_BOOL, *getRevArg(arguments, 0));
-		int arg2 = parseBool(*getRevArg(arguments, 1));
-		writeEquiv(arg2, arg1, false);
+		vector<int> arg1 = parseArray(VAR_BOOL, *arguments[0]);
+		writeRuleOrEquiv(args[1], arg1.size()==0?NULL:&arg1[0], arg1.size(), false);
 		break;}
 	case booleq:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> v; v.push_back(args[1]);
-		writeEquiv(args[0], v, true);
+		writeRuleOrEquiv(args[0], &args[1], 1, true);
 		break;}
 	case booleqr:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> bothttrue; bothttrue.push_back(args[0]); bothttrue.push_back(args[1]);
-		vector<int> bothfalse; bothfalse.push_back(-args[0]); bothfalse.push_back(-args[1]);
+		int bothttrue[] = {args[0], args[1]};
+		int bothfalse[] = {-args[0], -args[1]};
 		int bothtruereif = createOneShotVar();
 		int bothfalsereif = createOneShotVar();
-		writeEquiv(bothtruereif, bothttrue, true);
-		writeEquiv(bothfalsereif, bothfalse, true);
-		vector<int> oneofboth; oneofboth.push_back(bothfalsereif); oneofboth.push_back(bothtruereif);
-		writeEquiv(args[2], oneofboth, false);
+		writeEquiv(bothtruereif, bothttrue, 2, true);
+		writeEquiv(bothfalsereif, bothfalse, 2, true);
+		int oneofboth[] = {bothfalsereif, bothtruereif};
+		writeEquiv(args[2], oneofboth, 2, false);
 		break;}
 	case boolle:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		theory <<"-" <<args[0] <<" " <<args[1] <<" 0\n";
+		theory.addBinary(-args[0], args[1]);
 		break;}
 	case booller:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> rhs; rhs.push_back(-args[0]); rhs.push_back(args[1]);
-		writeEquiv(args[2], rhs, false);
+		int rhs[] = {-args[0], args[1]};
+		writeEquiv(args[2], rhs, 2, false);
 		break;}
 	case boollt:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		theory <<"-" <<args[0] <<" 0\n";
-		theory <<args[1] <<" 0\n";
+		theory.addUnit(-args[0]);
+		theory.addUnit(args[1]);
 		break;}
 	case boolltr:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> rhs; rhs.push_back(-args[0]); rhs.push_back(args[1]);
-		writeEquiv(args[2], rhs, true);
+		int rhs[] = {-args[0], args[1]};
+		writeEquiv(args[2], rhs, 2, true);
 		break;}
 	case boolnot:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> rhs; rhs.push_back(-args[0]);
-		writeEquiv(args[1], rhs, true);
+		int rhs[] = {-args[0]};
+		writeRuleOrEquiv(args[1], rhs, 1, true);
 		break;}
 	case boolor:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> rhs; rhs.push_back(args[0]); rhs.push_back(args[1]);
-		writeEquiv(args[2], rhs, false);
+		int rhs[] = {args[0], args[1]};
+		writeRuleOrEquiv(args[2], rhs, 2, false);
 		break;}
 	case boolxor:{
-		types.push_back(ARG_BOOL); types.push_back(ARG_BOOL); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		vector<int> firstfalse; firstfalse.push_back(-args[0]); firstfalse.push_back(args[1]);
-		vector<int> secondfalse; secondfalse.push_back(args[0]); secondfalse.push_back(-args[1]);
+		int firstfalse[] = {-args[0], args[1]};
+		int secondfalse[] = {args[0], -args[1]};
 		int firstfalsereif = createOneShotVar();
 		int secondfalsereif = createOneShotVar();
-		writeEquiv(firstfalsereif, firstfalse, true);
-		writeEquiv(secondfalsereif, secondfalse, true);
-		vector<int> oneofboth; oneofboth.push_back(firstfalsereif); oneofboth.push_back(secondfalsereif);
-		writeEquiv(args[2], oneofboth, false);
+		writeEquiv(firstfalsereif, firstfalse, 2, true);
+		writeEquiv(secondfalsereif, secondfalse, 2, true);
+		int oneofboth[] = {firstfalsereif, secondfalsereif};
+		writeEquiv(args[2], oneofboth, 2, false);
 		break;}
 	case inteq: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
-		addBinT(getTrue(vars), args[0], "=", args[1]);
+		addIntComparison(arguments, args, COMP_EQ, false);
 		break;}
 	case inteqr: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		addBinT(args[2], args[0], "=", args[1]);
+		addIntComparison(arguments, args, COMP_EQ, true);
 		break;}
 	case intle: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
-		addBinT(getTrue(vars), args[0], "=<", args[1]);
+		addIntComparison(arguments, args, COMP_LE, false);
 		break;}
 	case intler: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		addBinT(args[2], args[0], "=<", args[1]);
+		addIntComparison(arguments, args, COMP_LE, true);
 		break;}
 	case intlt: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
-		addBinT(getTrue(vars), args[0], "<", args[1]);
+		addIntComparison(arguments, args, COMP_LT, false);
 		break;}
 	case intltr: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		addBinT(args[2], args[0], "<", args[1]);
+		addIntComparison(arguments, args, COMP_LT, true);
 		break;}
 	case intne: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
-		addBinT(getTrue(vars), args[0], "~=", args[1]);
+		addIntComparison(arguments, args, COMP_NE, false);
 		break;}
 	case intner: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_BOOL);
-		parseArgs(arguments, args, types);
-		addBinT(args[2], args[0], "~=", args[1]);
+		addIntComparison(arguments, args, COMP_NE, true);
 		break;}
 	//TODO binary/ternary functions
 /*	case intabs: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<"abs(" <<args[0] <<")= " <<args[1] <<endst();
 		break;}
 	case intdiv: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<args[0] <<" / " <<args[1] <<" = " <<args[2] <<endst();
 		break;}
 	case intmax: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<"max(" <<args[0] <<", " <<args[1] <<")= " <<args[2]<<endst();
 		break;}
 	case intmin: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<"min(" <<args[0] <<", " <<args[1] <<")= " <<args[2] <<endst();
 		break;}
 	case intmod: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<args[0] <<" mod " <<args[1] <<" = " <<args[2] <<endst();
 		break;}
 	case intplus: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<args[0] <<" + " <<args[1] <<" = " <<args[2] <<endst();
 		break;}
 	case inttimes: {
-		types.push_back(ARG_INT); types.push_back(ARG_INT); types.push_back(ARG_INT);
-		parseArgs(arguments, args, types);
 		//theory <<tab() <<args[0] <<" * " <<args[1] <<" = " <<args[2] <<endst();
 		break;}*/
 	case intlineq: {
-		addLinear(arguments, "=", false);
+		addLinear(*var->id->name, arguments, args, COMP_EQ, false);
 		break;}
 	case intlineqr: {
-		addLinear(arguments, "=", true);
+		addLinear(*var->id->name, arguments, args, COMP_EQ, true);
 		break;}
 	case intlinle: {
-		addLinear(arguments, "=<", false);
+		addLinear(*var->id->name, arguments, args, COMP_LE, false);
 		break;}
 	case intlinler: {
-		addLinear(arguments, "=<", true);
+		addLinear(*var->id->name, arguments, args, COMP_LE, true);
 		break;}
 	case intlinne: {
-		addLinear(arguments, "~=", false);
+		addLinear(*var->id->name, arguments, args, COMP_NE, false);
 		break;}
 	case intlinner: {
-		addLinear(arguments, "~=", true);
+		addLinear(*var->id->name, arguments, args, COMP_NE, true);
+		break;}
+	case tableint: {
+		addTable(arguments, false);
+		break;}
+	case tablebool: {
+		addTable(arguments, true);
+		break;}
+	case setin: {
+		addSetIn(arguments, args, false);
+		break;}
+	case setinr: {
+		addSetIn(arguments, args, true);
+		break;}
+	case setcard: {
+		addSetCard(arguments, args);
+		break;}
+	case seteq: case seteqr: case setne: case setner: case setsubset: case setsubsetr: {
+		addSetRelation(arguments, args, signature.type);
+		break;}
+	case setunion: case setintersect: case setdiff: case setsymdiff: {
+		addSetOperation(arguments, signature.type);
 		break;}
 	default:
 		stringstream ss;
 		ss <<"Constraint " <<*var->id->name <<" is not a supported constraint.\n";
 		throw fzexception(ss.str());
 	}
+
+	if(stats.enabled){
+		double time = currentTime()-start;
+		stats.addConstraint(signature.type, time);
+		stats.phasetime[PHASE_CONSTRAINTS] += time;
+	}
 }
 
 void InsertWrapper::addOptim(Expression& expr, bool maxim){
@@ -455,33 +1613,91 @@ void InsertWrapper::addOptim(Expression& expr, bool maxim){
 	if(intvar->range){
 		for(int i=intvar->begin; i<=intvar->end; ++i){
 			int tempvar = createOneShotVar();
-			addBinI(tempvar, intvar->var, "=", i);
+			theory.addComparison(tempvar, intvar->var, COMP_EQ, i);
 			minorderedlist.push_back(tempvar);
 		}
 	}else{
 		sort(intvar->values.begin(), intvar->values.end());
 		for(vector<int>::const_iterator i=intvar->values.begin(); i<=intvar->values.end(); ++i){
 			int tempvar = createOneShotVar();
-			addBinI(tempvar, intvar->var, "=", *i);
+			theory.addComparison(tempvar, intvar->var, COMP_EQ, *i);
 			minorderedlist.push_back(tempvar);
 		}
 	}
 
 
-	theory <<"Mnmlist ";
 	if(maxim){
-		for(vector<int>::const_reverse_iterator i=minorderedlist.rbegin(); i<minorderedlist.rend(); ++i){
-			theory <<*i <<" ";
+		reverse(minorderedlist.begin(), minorderedlist.end());
+	}
+	theory.addMinimize(minorderedlist);
+}
+
+string getAnnotationName(const Expression& expr){
+	if(expr.type!=EXPR_IDENT){ throw fzexception("Unexpected type.\n"); }
+	return *expr.ident->name;
+}
+
+//int_search and bool_search become search hints, seq_search is flattened and other annotations are ignored
+void InsertWrapper::addSearchAnnotation(Expression& annotation){
+	if(annotation.type!=EXPR_IDENT){
+		return;
+	}
+	const string& name = *annotation.ident->name;
+	const vector<Expression*>& arguments = *annotation.ident->arguments;
+	if(name=="seq_search"){
+		if(arguments.size()!=1 || arguments[0]->type!=EXPR_ARRAY){ throw fzexception("Incorrect number of annotation arguments.\n"); }
+		const vector<Expression*>& searches = arguments[0]->arraylit->getExprs();
+		for(vector<Expression*>::const_iterator i=searches.begin(); i<searches.end(); ++i){
+			addSearchAnnotation(**i);
 		}
-	}else{
-		for(vector<int>::const_iterator i=minorderedlist.begin(); i<minorderedlist.end(); ++i){
-			theory <<*i <<" ";
+		return;
+	}
+	if(name!="int_search" && name!="bool_search"){
+		return;
+	}
+	if(arguments.size()!=4){ throw fzexception("Incorrect number of annotation arguments.\n"); }
+	SearchHint hint;
+	hint.booleans = name=="bool_search";
+	parseSearchVariables(*arguments[0], hint.booleans, hint.vars);
+	hint.varselect = getAnnotationName(*arguments[1]);
+	hint.valselect = getAnnotationName(*arguments[2]);
+	hint.strategy = getAnnotationName(*arguments[3]);
+	getSearchHints().push_back(hint);
+}
+
+//The variables can be an array by name, fixed values are left out
+void InsertWrapper::parseSearchVariables(Expression& expr, bool booleans, vector<int>& vars){
+	if(expr.type==EXPR_IDENT && booleans){
+		const vector<MBoolVar*>& elements = getBoolArrayVar(*expr.ident->name)->vars;
+		for(vector<MBoolVar*>::const_iterator i=elements.begin(); i<elements.end(); ++i){
+			vars.push_back((*i)->var);
+		}
+		return;
+	}
+	if(expr.type==EXPR_IDENT){
+		const vector<MIntVar*>& elements = getIntArrayVar(*expr.ident->name)->vars;
+		for(vector<MIntVar*>::const_iterator i=elements.begin(); i<elements.end(); ++i){
+			vars.push_back((*i)->var);
+		}
+		return;
+	}
+	if(expr.type!=EXPR_ARRAY){ throw fzexception("Unexpected type.\n"); }
+	if(expr.arraylit->literals!=LITERALS_NONE){
+		return;
+	}
+	for(vector<Expression*>::const_iterator i=expr.arraylit->exprs->begin(); i<expr.arraylit->exprs->end(); ++i){
+		if((*i)->type==EXPR_IDENT){
+			vars.push_back(getVar(*(*i)->ident->name, booleans));
+		}else if((*i)->type==EXPR_ARRAYACCESS){
+			vars.push_back(getVar(*(*i)->arrayaccesslit->id, (*i)->arrayaccesslit->index, booleans));
 		}
 	}
-	theory <<" 0\n";
 }
 
 void InsertWrapper::add(Search* search){
+	MemoryScope output(MEM_OUTPUT);
+	Statistics& stats = getStatistics();
+	double start = stats.enabled?currentTime():0;
 	switch(search->type){
 	case SOLVE_SATISFY:
 		break;
@@ -492,4 +1708,12 @@ void InsertWrapper::add(Search* search){
 		addOptim(*search->expr, true);
 		break;
 	}
+	if(search->annotations!=NULL){
+		for(vector<Expression*>::const_iterator i=search->annotations->begin(); i<search->annotations->end(); ++i){
+			addSearchAnnotation(**i);
+		}
+	}
+	if(stats.enabled){
+		stats.phasetime[PHASE_CONSTRAINTS] += currentTime()-start;
+	}
 }
@@ -11,57 +11,95 @@
 
 #include <vector>
 #include <string>
-#include <sstream>
 #include <map>
 #include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/ConstraintTable.hpp"
+#include "flatzincsupport/TranslationOptions.hpp"
+#include "flatzincsupport/Definitions.hpp"
+#include "flatzincsupport/EcnfSink.hpp"
+#include "flatzincsupport/StatementBuffer.hpp"
+#include "flatzincsupport/ParseContext.hpp"
 
 namespace FZ{
 
-enum CONSTRAINT_TYPE {
-	bool2int,
-
-	booland, boolclause, booleq, booleqr, boolle, booller, boollt, boolltr, boolnot, boolor, boolxor,
-
-	intabs, intdiv, inteq, inteqr, intle, intler, intlt, intltr, intmax, intmin, intmod, intne, intner, intplus, inttimes,
-	intlineq, intlineqr, intlinle, intlinler, intlinne, intlinner,
-
-	arraybooland, arrayboolor
+// A linear constraint kept until all bool2int channels are known
+struct LinearConstraint{
+	std::vector<int> weights, variables;
+	COMPARISON op;
+	int bound;
+	int head;	// 0 if it is not reified
 };
 
-enum ARG_TYPE { ARG_BOOL, ARG_INT, ARG_SET, ARG_ARRAY_OF_SET, ARG_ARRAY_OF_INT, ARG_ARRAY_OF_BOOL };
-
-class InsertWrapper {
+class InsertWrapper: public ItemHandler {
 private:
-	std::stringstream vars, theory;
-	std::map<int, std::stringstream*> definitions;
-	std::map<std::string, CONSTRAINT_TYPE> name2type;
+	EcnfSink& sink;
+	StatementBuffer vars, theory;	// The declarations and the constraints, passed on to the sink in this order by finish
+	std::map<int, std::vector<Rule> > definitions;	// The rules of each inductive definition, written at the end
+	bool defining;	// The constraint being added is annotated inductivelydefined(definitionid)
+	int definitionid;
+	int truelit; // Shared true literal, 0 if not yet created
+	int falselit;	// Shared variable that is false, 0 if not yet created
+	std::map<int, int> constants;	// Value to the integer variable fixed to it
+	bool unsatisfiable;	// A constraint is false, the others are skipped
+	int nextsetid;
+	std::map<int, int> channels;	// Integer variable to the boolean it is 1 for, by bool2int
+	std::vector<LinearConstraint> linears;
+	std::map<int, std::vector<std::pair<int, int> > > valuelits;	// Integer variable to its values and their literals, by value
 	void addFunc(const std::string& func, const std::vector<Expression*>& origargs);
-	void parseArgs(const std::vector<Expression*>& origargs, std::vector<int>& args, const std::vector<ARG_TYPE>& expectedtypes);
+	void parseArgs(const std::vector<Expression*>& origargs, int* args, const ConstraintSignature& signature);
 
 	void writeRule(int head, const std::vector<int>& body, bool conj, int definitionID);
 	void writeEquiv(int head, const std::vector<int>& body, bool conj);
+	void writeEquiv(int head, const int* body, int size, bool conj);
+	void writeRuleOrEquiv(int head, const int* body, int size, bool conj);
+	void writeDefinitions();
 
+	int parseBoolValue(bool value);
+	int parseIntValue(int value);
 	int parseBool(const Expression& expr);
 	int parseInt(const Expression& expr);
 	int parseParInt(const Expression& expr);
 	std::vector<int> parseArray(VAR_TYPE type, Expression& expr);
 	std::vector<int> parseParIntArray(Expression& expr);
-
-	template<class T>
-	void addBinT(const T& boolvar, int intvar, const std::string& op, int intvar2);
-	template<class T>
-	void addBinI(const T& boolvar, int intvar, const std::string& op, int parint);
-
-	void addLinear(const std::vector<Expression*>& arguments, const std::string& op, bool reif);
+	std::vector<int> parseParBoolArray(Expression& expr);
+	void parseSet(const Expression& expr, MSetVar& set);
+
+	int getTrueLit();
+	int getFalseLit();
+	bool getFixedValue(const Expression& expr, bool boolean, int& value);
+	void addFalse(const std::string& constraint);
+	bool addFixed(const std::string& name, CONSTRAINT_TYPE type, const std::vector<Expression*>& arguments);
+	int getMember(const MSetVar& set, int value);
+	int getEqualLit(int lit, int lit2);
+	void writeSetEquiv(int head, const std::vector<int>& body, bool conj);
+
+	bool getValueLits(const Expression& expr, std::vector<std::pair<int, int> >& lits);
+	void addIntComparison(const std::vector<Expression*>& arguments, const int* args, COMPARISON op, bool reif);
+	void addLinear(const std::string& name, const std::vector<Expression*>& arguments, const int* args, COMPARISON op, bool reif);
+	void writeLinear(const LinearConstraint& linear);
+	void writePseudoBoolean(const LinearConstraint& linear);
+	void fuseLinears();
+	void halfReify();
+	void addTable(const std::vector<Expression*>& arguments, bool booltable);
+
+	void addSetIn(const std::vector<Expression*>& arguments, const int* args, bool reif);
+	void addSetCard(const std::vector<Expression*>& arguments, const int* args);
+	void addSetRelation(const std::vector<Expression*>& arguments, const int* args, CONSTRAINT_TYPE type);
+	void addSetOperation(const std::vector<Expression*>& arguments, CONSTRAINT_TYPE type);
 
 	void addOptim(Expression& expr, bool maxim);
+	void addSearchAnnotation(Expression& annotation);
+	void parseSearchVariables(Expression& expr, bool booleans, std::vector<int>& vars);
+
+	void rename(const TranslationOptions& options);
 
 public:
-	InsertWrapper();
+	InsertWrapper(EcnfSink& sink);
 	virtual ~InsertWrapper();
 
 	void start	();
 	void finish	();
+	void addOutputStatistics() const;
 
 	void add	(Var* var);
 	void add	(Constraint* var);
@@ -0,0 +1,834 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/JsonParser.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/ParseContext.hpp"
+#include "flatzincsupport/ConstraintTable.hpp"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+namespace{
+
+bool isSpace(char c){
+	return c==' ' || c=='\n' || c=='\t' || c=='\r';
+}
+
+Expression* makeIdent(string* name, vector<Expression*>* arguments){
+	Expression* expr = new Expression();
+	expr->type = EXPR_IDENT;
+	expr->ident = new Identifier(name, arguments);
+	return expr;
+}
+
+// output_array([lo..hi, ...]) for the given dimensions
+Expression* makeOutputArray(const vector<pair<int, int> >& dims){
+	ArrayLiteral* list = new ArrayLiteral();
+	for(vector<pair<int, int> >::const_iterator i=dims.begin(); i<dims.end(); ++i){
+		Expression* dim = new Expression();
+		dim->type = EXPR_SET;
+		dim->setlit = new SetLiteral((*i).first, (*i).second);
+		list->add(dim);
+	}
+	Expression* arg = new Expression();
+	arg->type = EXPR_ARRAY;
+	arg->arraylit = list;
+	vector<Expression*>* args = new vector<Expression*>();
+	args->push_back(arg);
+	return makeIdent(new string("output_array"), args);
+}
+
+/**
+ * A recursive descent reader over the bytes of one JSON document.
+ * Strings are found with memchr and are not unescaped, FlatZinc identifiers have no escapes.
+ */
+class JsonReader{
+private:
+	const char* begin, *position, *end;
+
+public:
+	JsonReader(const char* begin, const char* end): begin(begin), position(begin), end(end){}
+
+	void fail(const char* message) const{
+		stringstream ss;
+		ss <<"Parsing error: " <<message <<" in the JSON input at byte " <<(position-begin) <<".\n";
+		throw fzexception(ss.str());
+	}
+
+	const char* getPosition() const { return position; }
+	void setPosition(const char* newposition) { position = newposition; }
+
+	char peek(){
+		while(position<end && isSpace(*position)){
+			++position;
+		}
+		return position<end?*position:'\0';
+	}
+
+	void expect(char c){
+		if(peek()!=c){
+			string message = "expected ";
+			message += c;
+			fail(message.c_str());
+		}
+		++position;
+	}
+
+	// After the opening bracket, false if the list or object is empty
+	bool first(char close){
+		if(peek()==close){
+			++position;
+			return false;
+		}
+		return true;
+	}
+
+	// After an element, true if another one follows
+	bool more(char close){
+		char c = peek();
+		++position;
+		if(c==','){
+			return true;
+		}else if(c!=close){
+			--position;
+			fail(close==']'?"expected , or ]":"expected , or }");
+		}
+		return false;
+	}
+
+	// Sets start and length to the contents of the string, without the quotes
+	void readString(const char*& start, size_t& length){
+		expect('"');
+		start = position;
+		while(true){
+			const char* quote = (const char*)memchr(position, '"', end-position);
+			if(quote==NULL){
+				position = end;
+				fail("unterminated string");
+			}
+			position = quote+1;
+			const char* escape = quote;
+			while(escape>start && *(escape-1)=='\\'){
+				--escape;
+			}
+			if((quote-escape)%2==0){
+				length = quote-start;
+				return;
+			}
+		}
+	}
+
+	string* readString(){
+		const char* start;
+		size_t length;
+		readString(start, length);
+		return new string(start, length);
+	}
+
+	// Reads a member name and its colon
+	void readKey(const char*& start, size_t& length){
+		readString(start, length);
+		expect(':');
+	}
+
+	bool readBool(){
+		char c = peek();
+		if(c=='t' && end-position>=4 && strncmp(position, "true", 4)==0){
+			position += 4;
+			return true;
+		}else if(c=='f' && end-position>=5 && strncmp(position, "false", 5)==0){
+			position += 5;
+			return false;
+		}
+		fail("expected true or false");
+		return false;
+	}
+
+	// Returns false if the number is not an integer, its value is then in real
+	bool readNumber(int& value, double& real){
+		peek();
+		const char* start = position;
+		bool negative = position<end && *position=='-';
+		if(negative){
+			++position;
+		}
+		if(position==end || *position<'0' || *position>'9'){
+			fail("expected a number");
+		}
+		long long number = 0;
+		while(position<end && *position>='0' && *position<='9'){
+			number = number*10+(*position-'0');
+			if(number>(long long)INT_MAX+1){
+				fail("integer out of range");
+			}
+			++position;
+		}
+		if(position<end && (*position=='.' || *position=='e' || *position=='E')){
+			while(position<end && (*position=='.' || *position=='e' || *position=='E' || *position=='+' || *position=='-'
+					|| (*position>='0' && *position<='9'))){
+				++position;
+			}
+			real = atof(string(start, position-start).c_str());
+			return false;
+		}
+		if(!negative && number>INT_MAX){
+			fail("integer out of range");
+		}
+		value = negative?-number:number;
+		return true;
+	}
+
+	int readInt(){
+		int value;
+		double real;
+		if(!readNumber(value, real)){
+			fail("expected an integer");
+		}
+		return value;
+	}
+
+	void skipValue(){
+		char c = peek();
+		if(c=='"'){
+			const char* start;
+			size_t length;
+			readString(start, length);
+			return;
+		}
+		if(c!='[' && c!='{'){
+			while(position<end && *position!=',' && *position!=']' && *position!='}' && !isSpace(*position)){
+				++position;
+			}
+			return;
+		}
+		int depth = 0;
+		while(position<end){
+			c = *position;
+			if(c=='"'){
+				const char* start;
+				size_t length;
+				readString(start, length);
+				continue;
+			}
+			if(c=='[' || c=='{'){
+				depth++;
+			}else if(c==']' || c=='}'){
+				if(--depth==0){
+					++position;
+					return;
+				}
+			}
+			++position;
+		}
+		fail("unexpected end");
+	}
+
+	// A list of ranges [[lo, hi], ...], a single integer is the range of one value
+	void readRanges(vector<pair<int, int> >& ranges){
+		expect('[');
+		for(bool m=first(']'); m; m=more(']')){
+			if(peek()=='['){
+				++position;
+				int lo = readInt();
+				expect(',');
+				int hi = readInt();
+				expect(']');
+				ranges.push_back(pair<int, int>(lo, hi));
+			}else{
+				int value = readInt();
+				ranges.push_back(pair<int, int>(value, value));
+			}
+		}
+	}
+
+	SetLiteral* readSet(){
+		vector<pair<int, int> > ranges;
+		readRanges(ranges);
+		if(ranges.size()==1){
+			return new SetLiteral(ranges[0].first, ranges[0].second);
+		}
+		return new SetLiteral(ranges);
+	}
+
+	// Int and bool literals go into the value buffer of the array, as in the text grammar
+	ArrayLiteral* readArray(){
+		ArrayLiteral* array = new ArrayLiteral();
+		try{
+			expect('[');
+			for(bool m=first(']'); m; m=more(']')){
+				char c = peek();
+				if(c=='-' || (c>='0' && c<='9')){
+					int value;
+					double real;
+					if(readNumber(value, real)){
+						array->addInt(value);
+					}else{
+						Expression* expr = new Expression();
+						expr->type = EXPR_FLOAT;
+						expr->floatlit = real;
+						array->add(expr);
+					}
+				}else if(c=='t' || c=='f'){
+					array->addBool(readBool());
+				}else{
+					array->add(readExpr());
+				}
+			}
+		}catch(...){
+			delete(array);
+			throw;
+		}
+		return array;
+	}
+
+	// The arguments of a call, NULL if the annotation is not read and was skipped
+	vector<Expression*>* readArguments(bool read){
+		if(!read){
+			skipValue();
+			return NULL;
+		}
+		ArrayLiteral* array = readArray();
+		vector<Expression*>* args = new vector<Expression*>(array->getExprs());
+		array->exprs->clear();
+		delete(array);
+		return args;
+	}
+
+	// {"id": name, "args": [...]}, NULL if the call is an annotation that is not read
+	Expression* readCall(bool annotation){
+		string* name = NULL;
+		vector<Expression*>* args = NULL;
+		bool hasargs = false;
+		const char* argsposition = NULL;
+		for(bool m=first('}'); m; m=more('}')){
+			const char* key;
+			size_t length;
+			readKey(key, length);
+			if(length==2 && strncmp(key, "id", 2)==0){
+				const char* start;
+				size_t namelength;
+				readString(start, namelength);
+				name = new string(start, namelength);
+			}else if(length==4 && strncmp(key, "args", 4)==0){
+				hasargs = true;
+				argsposition = position;
+				skipValue();
+			}else{
+				skipValue();
+			}
+		}
+		if(name==NULL){
+			fail("a call needs an id");
+		}
+		bool read = !annotation || isReadAnnotation(name->c_str(), name->size());
+		if(read && hasargs){
+			const char* after = position;
+			position = argsposition;
+			try{
+				args = readArguments(true);
+			}catch(...){
+				delete(name);
+				throw;
+			}
+			position = after;
+		}
+		if(!read){
+			delete(name);
+			return NULL;
+		}
+		return makeIdent(name, args!=NULL?args:new vector<Expression*>());
+	}
+
+	// A value as an expression: identifiers are strings, sets {"set": ranges}, strings {"string": text}
+	Expression* readExpr(){
+		char c = peek();
+		Expression* expr = NULL;
+		if(c=='"'){
+			return makeIdent(readString(), new vector<Expression*>());
+		}else if(c=='['){
+			expr = new Expression();
+			expr->type = EXPR_ARRAY;
+			expr->arraylit = readArray();
+		}else if(c=='t' || c=='f'){
+			expr = new Expression();
+			expr->type = EXPR_BOOL;
+			expr->boollit = readBool();
+		}else if(c=='-' || (c>='0' && c<='9')){
+			expr = new Expression();
+			double real;
+			if(readNumber(expr->intlit, real)){
+				expr->type = EXPR_INT;
+			}else{
+				expr->type = EXPR_FLOAT;
+				expr->floatlit = real;
+			}
+		}else if(c=='{'){
+			const char* object = position;
+			++position;
+			const char* key;
+			size_t length;
+			if(peek()=='"'){
+				readKey(key, length);
+				if(length==3 && strncmp(key, "set", 3)==0){
+					expr = new Expression();
+					expr->type = EXPR_SET;
+					expr->setlit = readSet();
+				}else if(length==6 && strncmp(key, "string", 6)==0){
+					expr = new Expression();
+					expr->type = EXPR_STRING;
+					expr->stringlit = readString();
+					expr->stringlit->insert(0, "\"");
+					expr->stringlit->append("\"");
+				}
+			}
+			if(expr==NULL){
+				position = object+1;
+				expr = readCall(false);
+			}else if(more('}')){
+				fail("expected }");
+			}
+		}else{
+			fail("expected a value");
+		}
+		return expr;
+	}
+
+	// The annotations of an item that the translator reads, the others are skipped
+	vector<Expression*>* readAnnotations(){
+		vector<Expression*>* annotations = new vector<Expression*>();
+		try{
+			expect('[');
+			for(bool m=first(']'); m; m=more(']')){
+				if(peek()=='"'){
+					const char* start;
+					size_t length;
+					readString(start, length);
+					if(isReadAnnotation(start, length)){
+						annotations->push_back(makeIdent(new string(start, length), new vector<Expression*>()));
+					}
+				}else{
+					expect('{');
+					Expression* annotation = readCall(true);
+					if(annotation!=NULL){
+						annotations->push_back(annotation);
+					}
+				}
+			}
+		}catch(...){
+			deleteList(annotations);
+			throw;
+		}
+		return annotations;
+	}
+};
+
+/**
+ * Turns the members of the model into items, in the order of the text format.
+ * The types of the variables are kept to type the arrays, whose elements are only names.
+ */
+class JsonModel{
+private:
+	JsonReader& reader;
+	ItemHandler& handler;
+	set<string> outputs;
+	map<string, VAR_TYPE> types;
+
+	bool isOutput(const string& name) const { return outputs.find(name)!=outputs.end(); }
+
+	void addOutputVar(Identifier& id){
+		for(vector<Expression*>::const_iterator i=id.arguments->begin(); i<id.arguments->end(); ++i){
+			if((*i)->type==EXPR_IDENT && (*i)->ident->name->compare("output_var")==0){
+				return;
+			}
+		}
+		id.arguments->push_back(makeIdent(new string("output_var"), new vector<Expression*>()));
+	}
+
+	template<typename T>
+	void add(T* item){
+		try{
+			handler.add(item);
+		}catch(...){
+			delete(item);
+			throw;
+		}
+		delete(item);
+	}
+
+public:
+	JsonModel(JsonReader& reader, ItemHandler& handler): reader(reader), handler(handler){}
+
+	void readOutputs(){
+		reader.expect('[');
+		for(bool m=reader.first(']'); m; m=reader.more(']')){
+			const char* start;
+			size_t length;
+			reader.readString(start, length);
+			outputs.insert(string(start, length));
+		}
+	}
+
+	// "name": {"type": "int", "domain": [[lo, hi], ...], "set": true, "rhs": value, "ann": [...]}
+	void readVariables(){
+		reader.expect('{');
+		for(bool m=reader.first('}'); m; m=reader.more('}')){
+			string* name = reader.readString();
+			reader.expect(':');
+			string type;
+			vector<pair<int, int> > domain;
+			const char* domainposition = NULL;	// Read once the type is known, float domains are not
+			bool isset = false, output = false;
+			Expression* rhs = NULL;
+			vector<Expression*>* annotations = NULL;
+			try{
+				reader.expect('{');
+				for(bool n=reader.first('}'); n; n=reader.more('}')){
+					const char* key;
+					size_t length;
+					reader.readKey(key, length);
+					if(length==4 && strncmp(key, "type", 4)==0){
+						const char* start;
+						size_t typelength;
+						reader.readString(start, typelength);
+						type.assign(start, typelength);
+					}else if(length==6 && strncmp(key, "domain", 6)==0){
+						reader.peek();
+						domainposition = reader.getPosition();
+						reader.skipValue();
+					}else if(length==3 && strncmp(key, "set", 3)==0){
+						isset = reader.readBool();
+					}else if(length==6 && strncmp(key, "output", 6)==0 && reader.peek()!='['){
+						output = reader.readBool();
+					}else if(length==3 && strncmp(key, "rhs", 3)==0){
+						rhs = reader.readExpr();
+					}else if(length==3 && strncmp(key, "ann", 3)==0 && annotations==NULL){
+						annotations = reader.readAnnotations();
+					}else{
+						reader.skipValue();
+					}
+				}
+				if(domainposition!=NULL && type.compare("int")==0){
+					const char* after = reader.getPosition();
+					reader.setPosition(domainposition);
+					reader.readRanges(domain);
+					reader.setPosition(after);
+				}
+			}catch(...){
+				delete(name);
+				if(rhs!=NULL){ delete(rhs); }
+				if(annotations!=NULL){ deleteList(annotations); }
+				throw;
+			}
+
+			Var* var = NULL;
+			if(type.compare("bool")==0){
+				var = new Var(VAR_BOOL);
+			}else if(type.compare("int")==0){
+				IntVar* intvar;
+				if(domain.empty()){
+					intvar = new IntVar();
+				}else if(domain.size()==1){
+					intvar = new IntVar(domain[0].first, domain[0].second);
+				}else{
+					intvar = new IntVar(domain);
+				}
+				var = isset?(Var*)new SetVar(intvar):(Var*)intvar;
+			}else if(type.compare("float")==0){
+				var = new Var(VAR_FLOAT);
+			}else{
+				delete(name);
+				if(rhs!=NULL){ delete(rhs); }
+				if(annotations!=NULL){ deleteList(annotations); }
+				reader.fail("a variable needs a type bool, int or float");
+			}
+			types[*name] = var->type;
+			var->id = new Identifier(name, annotations!=NULL?annotations:new vector<Expression*>());
+			var->expr = rhs;
+			if(output || isOutput(*name)){
+				addOutputVar(*var->id);
+			}
+			add(var);
+		}
+	}
+
+	// "name": {"a": [...], "ann": [...], "output": [[lo, hi], ...]}, the elements are literals or variable names
+	void readArrays(){
+		reader.expect('{');
+		for(bool m=reader.first('}'); m; m=reader.more('}')){
+			string* name = reader.readString();
+			reader.expect(':');
+			ArrayLiteral* array = NULL;
+			vector<Expression*>* annotations = NULL;
+			vector<pair<int, int> > dims;
+			bool output = false;
+			try{
+				reader.expect('{');
+				for(bool n=reader.first('}'); n; n=reader.more('}')){
+					const char* key;
+					size_t length;
+					reader.readKey(key, length);
+					if(length==1 && key[0]=='a' && array==NULL){
+						array = reader.readArray();
+					}else if(length==3 && strncmp(key, "ann", 3)==0 && annotations==NULL){
+						annotations = reader.readAnnotations();
+					}else if(length==6 && strncmp(key, "output", 6)==0){
+						if(reader.peek()=='['){
+							reader.readRanges(dims);
+							output = true;
+						}else{
+							output = reader.readBool();
+						}
+					}else{
+						reader.skipValue();
+					}
+				}
+				if(array==NULL){
+					reader.fail("an array needs its elements a");
+				}
+			}catch(...){
+				delete(name);
+				if(array!=NULL){ delete(array); }
+				if(annotations!=NULL){ deleteList(annotations); }
+				throw;
+			}
+
+			// The array is of variables if an element names one, its type is that of its first typed element
+			bool isvar = false;
+			int type = array->literals==LITERALS_BOOL?VAR_BOOL:VAR_INT;
+			if(array->exprs!=NULL){
+				bool typed = false;
+				for(vector<Expression*>::const_iterator i=array->exprs->begin(); i<array->exprs->end(); ++i){
+					int elemtype = -1;
+					switch((*i)->type){
+					case EXPR_BOOL: elemtype = VAR_BOOL; break;
+					case EXPR_INT: elemtype = VAR_INT; break;
+					case EXPR_SET: elemtype = VAR_SET; break;
+					case EXPR_FLOAT: elemtype = VAR_FLOAT; break;
+					case EXPR_IDENT:{
+						map<string, VAR_TYPE>::const_iterator var = types.find(*(*i)->ident->name);
+						if(var==types.end()){
+							string message = "array " +*name +" refers to the undeclared variable " +*(*i)->ident->name;
+							delete(name);
+							delete(array);
+							if(annotations!=NULL){ deleteList(annotations); }
+							reader.fail(message.c_str());
+						}
+						isvar = true;
+						elemtype = (*var).second;
+						break;}
+					default: break;
+					}
+					if(!typed && elemtype>=0){
+						type = elemtype;
+						typed = true;
+					}
+				}
+			}
+			Var* rangevar;
+			if(type==VAR_BOOL){
+				rangevar = new Var(VAR_BOOL);
+			}else if(type==VAR_SET){
+				rangevar = new SetVar(new IntVar());
+			}else if(type==VAR_FLOAT){
+				rangevar = new Var(VAR_FLOAT);
+			}else{
+				rangevar = new IntVar();
+			}
+			ArrayVar* var = new ArrayVar(rangevar, array);
+			var->begin = 1;
+			var->end = array->size();
+			var->var = isvar;
+			var->id = new Identifier(name, annotations!=NULL?annotations:new vector<Expression*>());
+			if(output || isOutput(*name)){
+				if(dims.empty()){
+					dims.push_back(pair<int, int>(1, array->size()));
+				}
+				var->id->arguments->push_back(makeOutputArray(dims));
+			}
+			add(var);
+		}
+	}
+
+	// [{"id": name, "args": [...], "ann": [...]}, ...]
+	void readConstraints(){
+		reader.expect('[');
+		for(bool m=reader.first(']'); m; m=reader.more(']')){
+			string* name = NULL;
+			vector<Expression*>* args = NULL, *annotations = NULL;
+			try{
+				reader.expect('{');
+				for(bool n=reader.first('}'); n; n=reader.more('}')){
+					const char* key;
+					size_t length;
+					reader.readKey(key, length);
+					if(length==2 && strncmp(key, "id", 2)==0 && name==NULL){
+						name = reader.readString();
+					}else if(length==4 && strncmp(key, "args", 4)==0 && args==NULL){
+						args = reader.readArguments(true);
+					}else if(length==3 && strncmp(key, "ann", 3)==0 && annotations==NULL){
+						annotations = reader.readAnnotations();
+					}else{
+						reader.skipValue();
+					}
+				}
+				if(name==NULL){
+					reader.fail("a constraint needs an id");
+				}
+			}catch(...){
+				if(name!=NULL){ delete(name); }
+				if(args!=NULL){ deleteList(args); }
+				if(annotations!=NULL){ deleteList(annotations); }
+				throw;
+			}
+			Constraint* constraint = new Constraint(new Identifier(name, args!=NULL?args:new vector<Expression*>()));
+			constraint->type = findConstraint(*name);
+			constraint->annotations = annotations!=NULL?annotations:new vector<Expression*>();
+			add(constraint);
+		}
+	}
+
+	// {"method": "satisfy" | "minimize" | "maximize", "objective": value, "ann": [...]}
+	void readSolve(){
+		string method;
+		Expression* objective = NULL;
+		vector<Expression*>* annotations = NULL;
+		try{
+			reader.expect('{');
+			for(bool m=reader.first('}'); m; m=reader.more('}')){
+				const char* key;
+				size_t length;
+				reader.readKey(key, length);
+				if(length==6 && strncmp(key, "method", 6)==0){
+					const char* start;
+					size_t methodlength;
+					reader.readString(start, methodlength);
+					method.assign(start, methodlength);
+				}else if(length==9 && strncmp(key, "objective", 9)==0 && objective==NULL){
+					objective = reader.readExpr();
+				}else if(length==3 && strncmp(key, "ann", 3)==0 && annotations==NULL){
+					annotations = reader.readAnnotations();
+				}else{
+					reader.skipValue();
+				}
+			}
+			if(method.compare("satisfy")!=0 && objective==NULL){
+				reader.fail(method.compare("minimize")==0 || method.compare("maximize")==0
+						?"an optimization needs an objective":"the solve method is satisfy, minimize or maximize");
+			}
+		}catch(...){
+			if(objective!=NULL){ delete(objective); }
+			if(annotations!=NULL){ deleteList(annotations); }
+			throw;
+		}
+		SOLVE_TYPE type = method.compare("satisfy")==0?SOLVE_SATISFY:method.compare("minimize")==0?SOLVE_MINIMIZE:SOLVE_MAXIMIZE;
+		Search* search = new Search(type, type==SOLVE_SATISFY?NULL:objective);
+		if(type==SOLVE_SATISFY && objective!=NULL){
+			delete(objective);
+		}
+		search->annotations = annotations!=NULL?annotations:new vector<Expression*>();
+		add(search);
+	}
+};
+
+}
+
+bool FZ::isJson(const char* begin, const char* end){
+	while(begin<end && isSpace(*begin)){
+		++begin;
+	}
+	return begin<end && *begin=='{';
+}
+
+bool FZ::readJson(FILE* in, string& input){
+	int c;
+	do{
+		c = getc(in);
+	}while(c!=EOF && isSpace(c));
+	if(c==EOF){
+		return false;
+	}
+	ungetc(c, in);
+	if(c!='{'){
+		return false;
+	}
+	char buffer[1<<16];
+	size_t count;
+	while((count = fread(buffer, 1, sizeof(buffer), in))>0){
+		input.append(buffer, count);
+	}
+	if(ferror(in)){
+		throw fzexception("File could not be read, aborting.\n");
+	}
+	return true;
+}
+
+void FZ::parseJson(const char* begin, const char* end, ItemHandler& handler){
+	JsonReader reader(begin, end);
+
+	// Locate the members first, the output names are needed before the variables
+	const char* variables = NULL, *arrays = NULL, *constraints = NULL, *output = NULL, *solve = NULL;
+	reader.expect('{');
+	for(bool m=reader.first('}'); m; m=reader.more('}')){
+		const char* key;
+		size_t length;
+		reader.readKey(key, length);
+		reader.peek();
+		const char* position = reader.getPosition();
+		string name(key, length);
+		if(name.compare("variables")==0){
+			variables = position;
+		}else if(name.compare("arrays")==0){
+			arrays = position;
+		}else if(name.compare("constraints")==0){
+			constraints = position;
+		}else if(name.compare("output")==0){
+			output = position;
+		}else if(name.compare("solve")==0){
+			solve = position;
+		}
+		reader.skipValue();
+	}
+	if(reader.peek()!='\0'){
+		reader.fail("unexpected content after the model");
+	}
+	if(solve==NULL){
+		reader.fail("the model has no solve item");
+	}
+
+	JsonModel model(reader, handler);
+	if(output!=NULL){
+		reader.setPosition(output);
+		model.readOutputs();
+	}
+	handler.start();
+	if(variables!=NULL){
+		reader.setPosition(variables);
+		model.readVariables();
+	}
+	if(arrays!=NULL){
+		reader.setPosition(arrays);
+		model.readArrays();
+	}
+	if(constraints!=NULL){
+		reader.setPosition(constraints);
+		model.readConstraints();
+	}
+	reader.setPosition(solve);
+	model.readSolve();
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef JSONPARSER_HPP_
+#define JSONPARSER_HPP_
+
+#include <cstdio>
+#include <string>
+
+namespace FZ{
+
+class ItemHandler;
+
+// FlatZinc in JSON is one object, text FlatZinc never starts with {
+bool isJson(const char* begin, const char* end);
+
+// Reads all of in if it is FlatZinc in JSON, otherwise only the leading whitespace
+bool readJson(FILE* in, std::string& input);
+
+/**
+ * Parses FlatZinc in JSON (the variables, arrays, constraints, output and solve members of the model object)
+ * into the same items as the text grammar, given to the handler in the order variables, arrays, constraints, solve.
+ * The members of the model are located first, so they may be in any order. Arrays of int or bool literals
+ * go straight into the value buffer of their ArrayLiteral, and only the annotations the translator reads are built.
+ * The handler gets start first and the items are deleted after they are added.
+ */
+void parseJson(const char* begin, const char* end, ItemHandler& handler);
+
+}
+
+#endif /* JSONPARSER_HPP_ */
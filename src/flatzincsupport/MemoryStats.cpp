@@ -0,0 +1,181 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/MemoryStats.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <new>
+
+using namespace std;
+using namespace FZ;
+
+const char* memtagnames[NBMEMTAGS] = { "other", "ast", "symbols", "records", "output" };
+
+#ifdef MEMSTATS
+
+namespace{
+	struct TagUsage{
+		atomic<long long> current, peak, allocations;
+	};
+	// Zero initialized before any constructor runs, so allocations during static initialization are counted too
+	TagUsage usage[NBMEMTAGS];
+	TagUsage total;
+	thread_local MEMTAG currenttag = MEM_OTHER;
+
+	// The parser threads allocate too, so any thread can take a sample
+	atomic<long long> samplecounter;
+	atomic<double> sampleinterval(0), lastsample(0);
+
+	// Keeps the returned memory aligned for any type
+	const size_t headersize = 16;
+	struct Header{
+		size_t size;
+		int tag;
+	};
+
+	double monotonicTime(){
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+		return time.tv_sec+time.tv_nsec/1000000000.0;
+	}
+
+	// Uses stdio only, as iostreams could allocate
+	void sample(){
+		double now = monotonicTime();
+		double last = lastsample;
+		// Only the thread that moves lastsample prints
+		if(now-last<sampleinterval || !lastsample.compare_exchange_strong(last, now)){
+			return;
+		}
+		fprintf(stderr, "memory");
+		for(int i=0; i<NBMEMTAGS; ++i){
+			fprintf(stderr, " %s=%lld", memtagnames[i], usage[i].current.load());
+		}
+		fprintf(stderr, "\n");
+	}
+
+	void* allocate(size_t size){
+		char* memory = (char*)malloc(size+headersize);
+		if(memory==NULL){
+			throw bad_alloc();
+		}
+		Header* header = (Header*)memory;
+		header->size = size;
+		header->tag = currenttag;
+		TagUsage& tagusage = usage[currenttag];
+		tagusage.allocations++;
+		long long current = tagusage.current += size;
+		long long peak = tagusage.peak;
+		while(current>peak && !tagusage.peak.compare_exchange_weak(peak, current)){
+		}
+		total.allocations++;
+		current = total.current += size;
+		peak = total.peak;
+		while(current>peak && !total.peak.compare_exchange_weak(peak, current)){
+		}
+		if(sampleinterval>0 && (++samplecounter & 0xFFFF)==0){
+			sample();
+		}
+		return memory+headersize;
+	}
+
+	void release(void* pointer){
+		if(pointer==NULL){
+			return;
+		}
+		Header* header = (Header*)((char*)pointer-headersize);
+		usage[header->tag].current -= header->size;
+		total.current -= header->size;
+		free(header);
+	}
+}
+
+void* operator new(size_t size){ return allocate(size); }
+void* operator new[](size_t size){ return allocate(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept{
+	try{ return allocate(size); }catch(...){ return NULL; }
+}
+void* operator new[](size_t size, const nothrow_t&) noexcept{
+	try{ return allocate(size); }catch(...){ return NULL; }
+}
+void operator delete(void* pointer) noexcept{ release(pointer); }
+void operator delete[](void* pointer) noexcept{ release(pointer); }
+void operator delete(void* pointer, size_t) noexcept{ release(pointer); }
+void operator delete[](void* pointer, size_t) noexcept{ release(pointer); }
+void operator delete(void* pointer, const nothrow_t&) noexcept{ release(pointer); }
+void operator delete[](void* pointer, const nothrow_t&) noexcept{ release(pointer); }
+
+MemoryScope::MemoryScope(MEMTAG tag): previous(currenttag){
+	currenttag = tag;
+}
+
+MemoryScope::~MemoryScope(){
+	currenttag = previous;
+}
+
+bool FZ::memoryStatsAvailable(){
+	return true;
+}
+
+MemoryUsage FZ::getMemoryUsage(MEMTAG tag){
+	const TagUsage& tagusage = tag==NBMEMTAGS?total:usage[tag];
+	MemoryUsage result;
+	result.current = tagusage.current;
+	result.peak = tagusage.peak;
+	result.allocations = tagusage.allocations;
+	return result;
+}
+
+void FZ::setMemorySampling(double interval){
+	lastsample = monotonicTime();
+	sampleinterval = interval;
+}
+
+#else
+
+bool FZ::memoryStatsAvailable(){
+	return false;
+}
+
+MemoryUsage FZ::getMemoryUsage(MEMTAG){
+	MemoryUsage result;
+	result.current = result.peak = result.allocations = 0;
+	return result;
+}
+
+void FZ::setMemorySampling(double){
+}
+
+#endif
+
+void FZ::writeMemoryUsage(ostream& out, bool json){
+	if(!memoryStatsAvailable()){
+		out <<(json?"{}\n":"Memory statistics are not available, configure with --enable-memstats.\n");
+		return;
+	}
+	if(json){
+		out <<"{";
+		for(int i=0; i<=NBMEMTAGS; ++i){
+			MemoryUsage tagusage = getMemoryUsage((MEMTAG)i);
+			out <<(i==0?"":", ") <<"\"" <<(i==NBMEMTAGS?"total":memtagnames[i]) <<"\": {\"current\": " <<tagusage.current <<", \"peak\": " <<tagusage.peak
+				<<", \"allocations\": " <<tagusage.allocations <<"}";
+		}
+		out <<"}\n";
+		return;
+	}
+	out <<"Memory (current bytes, peak bytes, allocations):\n";
+	for(int i=0; i<=NBMEMTAGS; ++i){
+		MemoryUsage tagusage = getMemoryUsage((MEMTAG)i);
+		out <<"    " <<setw(20) <<left <<(i==NBMEMTAGS?"total":memtagnames[i]) <<right
+			<<setw(14) <<tagusage.current <<setw(14) <<tagusage.peak <<setw(12) <<tagusage.allocations <<"\n";
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef MEMORYSTATS_HPP_
+#define MEMORYSTATS_HPP_
+
+#include <ostream>
+
+namespace FZ{
+
+/**
+ * Allocation accounting by subsystem, only compiled in with --enable-memstats (defines MEMSTATS).
+ * Every allocation is charged to the tag of the innermost MemoryScope and released to that same tag.
+ * MEM_OUTPUT also holds the temporaries of the translation of an item.
+ */
+enum MEMTAG { MEM_OTHER, MEM_AST, MEM_SYMBOLS, MEM_RECORDS, MEM_OUTPUT, NBMEMTAGS };
+
+struct MemoryUsage{
+	long long current, peak, allocations;
+};
+
+#ifdef MEMSTATS
+class MemoryScope{
+private:
+	MEMTAG previous;
+public:
+	MemoryScope(MEMTAG tag);
+	~MemoryScope();
+};
+#else
+class MemoryScope{
+public:
+	MemoryScope(MEMTAG){}
+};
+#endif
+
+bool memoryStatsAvailable();
+MemoryUsage getMemoryUsage(MEMTAG tag);	// NBMEMTAGS gives the total over all tags
+
+// Prints the usage per tag to stderr every interval seconds, 0 disables it
+void setMemorySampling(double interval);
+void writeMemoryUsage(std::ostream& out, bool json);
+
+}
+
+#endif /* MEMORYSTATS_HPP_ */
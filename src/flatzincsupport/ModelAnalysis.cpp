@@ -0,0 +1,344 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/ModelAnalysis.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <iomanip>
+
+#include "flatzincsupport/ConstraintTable.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
+#include "flatzincsupport/JsonParser.hpp"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+const char* vartypenames[VAR_ARRAY] = { "bool", "int", "set", "float" };
+const char* domainsizenames[NBDOMAINSIZES] = { "0", "1", "2", "3-8", "9-64", "65-1024", "1025+", "unbounded" };
+
+namespace{
+
+DOMAIN_SIZE getDomainSize(long long size){
+	if(size==0){
+		return DOMAIN_0;
+	}else if(size==1){
+		return DOMAIN_1;
+	}else if(size==2){
+		return DOMAIN_2;
+	}else if(size<=8){
+		return DOMAIN_8;
+	}else if(size<=64){
+		return DOMAIN_64;
+	}else if(size<=1024){
+		return DOMAIN_1024;
+	}
+	return DOMAIN_LARGER;
+}
+
+// The number of values of an integer, -1 if it is unbounded
+long long getNbValues(const IntVar& var){
+	if(var.range){
+		long long size = (long long)var.end-var.begin+1;
+		for(vector<pair<int, int> >::const_iterator i=var.holes.begin(); i<var.holes.end(); ++i){
+			size -= (long long)(*i).second-(*i).first+1;
+		}
+		return max(0LL, size);
+	}else if(var.enumvalues){
+		return var.values->size();
+	}
+	return -1;
+}
+
+}
+
+ModelAnalysis::ModelAnalysis(): parameters(0), arrays(0), arrayelements(0), largestarray(0), unsupported(0), solve("none"),
+		setmembers(0), auxvars(0), statements(0), tokens(0), incidences(0), largestarity(0){
+	for(int i=0; i<VAR_ARRAY; ++i){
+		variables[i] = 0;
+	}
+	for(int i=0; i<NBDOMAINSIZES; ++i){
+		domains[i] = 0;
+	}
+}
+
+int ModelAnalysis::createNode(){
+	parents.push_back(parents.size());
+	degrees.push_back(0);
+	return parents.size()-1;
+}
+
+int ModelAnalysis::findComponent(int node){
+	while(parents[node]!=node){
+		parents[node] = parents[parents[node]];
+		node = parents[node];
+	}
+	return node;
+}
+
+// Counts count variables of the type, with the domain of the declaration domain (NULL if it has none)
+void ModelAnalysis::addVariable(VAR_TYPE type, const Var* domain, int count){
+	variables[type] += count;
+	const IntVar* intvar = dynamic_cast<const IntVar*>(domain);
+	if(type==VAR_INT && intvar!=NULL){
+		long long size = getNbValues(*intvar);
+		domains[size<0?DOMAIN_UNBOUNDED:getDomainSize(size)] += count;
+		statements += count;
+		tokens += count*(intvar->enumvalues?size+4:5);
+	}
+	const SetVar* setvar = dynamic_cast<const SetVar*>(domain);
+	if(type==VAR_SET && setvar!=NULL && setvar->var!=NULL){
+		setmembers += count*max(0LL, getNbValues(*setvar->var));
+	}
+}
+
+// Returns -1 if the expression is not a variable
+int ModelAnalysis::getNode(const Expression& expr) const{
+	if(expr.type==EXPR_IDENT){
+		map<string, int>::const_iterator node = nodes.find(*expr.ident->name);
+		return node==nodes.end()?-1:(*node).second;
+	}else if(expr.type==EXPR_ARRAYACCESS){
+		map<string, vector<int> >::const_iterator array = arraynodes.find(*expr.arrayaccesslit->id);
+		int index = expr.arrayaccesslit->index-1;
+		if(array!=arraynodes.end() && index>=0 && index<(int)(*array).second.size()){
+			return (*array).second[index];
+		}
+	}
+	return -1;
+}
+
+// Adds the nodes of the argument, returns its number of elements
+int ModelAnalysis::addArgument(const Expression& expr, vector<int>& argnodes){
+	if(expr.type==EXPR_ARRAY){
+		if(expr.arraylit->exprs==NULL){
+			return expr.arraylit->size();
+		}
+		int size = 0;
+		for(vector<Expression*>::const_iterator i=expr.arraylit->exprs->begin(); i<expr.arraylit->exprs->end(); ++i){
+			size += addArgument(**i, argnodes);
+		}
+		return size;
+	}
+	if(expr.type==EXPR_IDENT){
+		map<string, vector<int> >::const_iterator array = arraynodes.find(*expr.ident->name);
+		if(array!=arraynodes.end()){
+			for(vector<int>::const_iterator i=(*array).second.begin(); i<(*array).second.end(); ++i){
+				if(*i>=0){
+					argnodes.push_back(*i);
+				}
+			}
+			return (*array).second.size();
+		}
+	}
+	int node = getNode(expr);
+	if(node>=0){
+		argnodes.push_back(node);
+	}
+	return 1;
+}
+
+// Adds what InsertWrapper::add(Constraint*) roughly writes for a constraint with arguments of these sizes
+void ModelAnalysis::estimate(int type, const vector<int>& sizes){
+	long long elements = 0;
+	for(vector<int>::const_iterator i=sizes.begin(); i<sizes.end(); ++i){
+		elements += *i;
+	}
+	switch(type){
+	case -1:
+		break;
+	case booleqr: case boolxor:
+		auxvars += 2;
+		statements += 3;
+		tokens += 18;
+		break;
+	case boollt:
+		statements += 2;
+		tokens += 4;
+		break;
+	case tableint: case tablebool:{
+		if(sizes.size()<2){
+			break;
+		}
+		long long arity = max(1, sizes[0]);
+		long long rows = sizes[1]/arity;
+		auxvars += rows;
+		statements += rows+1;
+		tokens += rows*(arity+4)+2;
+		break;}
+	case setcard: case setdiff: case seteq: case seteqr: case setin: case setinr: case setintersect: case setne: case setner:
+	case setsubset: case setsubsetr: case setsymdiff: case setunion:
+		// The universes of the sets are not resolved, count a value per argument
+		auxvars += elements;
+		statements += 2*elements;
+		tokens += 8*elements;
+		break;
+	default:
+		statements++;
+		tokens += elements+4;
+		break;
+	}
+}
+
+void ModelAnalysis::start(){
+}
+
+void ModelAnalysis::add(Var* var){
+	if(var->type==VAR_ARRAY){
+		const ArrayVar& array = *dynamic_cast<ArrayVar*>(var);
+		int size = max(0, array.end-array.begin+1);
+		arrays++;
+		arrayelements += size;
+		largestarray = max(largestarray, (long long)size);
+		vector<int>& elements = arraynodes[var->getName()];
+		elements.clear();
+		if(array.arraylit!=NULL && array.arraylit->exprs!=NULL){
+			for(vector<Expression*>::const_iterator i=array.arraylit->exprs->begin(); i<array.arraylit->exprs->end(); ++i){
+				elements.push_back(getNode(**i));
+			}
+		}else if(array.arraylit!=NULL || !array.var){
+			elements.assign(size, -1);
+		}else{
+			addVariable(array.rangevar!=NULL?array.rangevar->type:array.rangetype, array.rangevar, size);
+			for(int i=0; i<size; ++i){
+				elements.push_back(createNode());
+			}
+		}
+		return;
+	}
+	if(!var->var){
+		parameters++;
+		return;
+	}
+	int alias = var->expr!=NULL?getNode(*var->expr):-1;
+	if(alias>=0){
+		nodes[var->getName()] = alias;
+		return;
+	}
+	addVariable(var->type, var, 1);
+	nodes[var->getName()] = createNode();
+}
+
+void ModelAnalysis::add(Constraint* constraint){
+	constraints[*constraint->id->name]++;
+	if(constraint->type<0 || getSignature((CONSTRAINT_TYPE)constraint->type).unsupported){
+		unsupported++;
+	}
+
+	vector<int> argnodes, sizes;
+	if(constraint->id->arguments!=NULL){
+		for(vector<Expression*>::const_iterator i=constraint->id->arguments->begin(); i<constraint->id->arguments->end(); ++i){
+			if((*i)->type==EXPR_INT){
+				constants.insert((*i)->intlit);
+			}
+			sizes.push_back(addArgument(**i, argnodes));
+		}
+	}
+	estimate(constraint->type, sizes);
+
+	sort(argnodes.begin(), argnodes.end());
+	argnodes.erase(unique(argnodes.begin(), argnodes.end()), argnodes.end());
+	incidences += argnodes.size();
+	largestarity = max(largestarity, (long long)argnodes.size());
+	for(vector<int>::const_iterator i=argnodes.begin(); i<argnodes.end(); ++i){
+		degrees[*i]++;
+		parents[findComponent(*i)] = findComponent(argnodes[0]);
+	}
+}
+
+void ModelAnalysis::add(Search* search){
+	solve = search->type==SOLVE_SATISFY?"satisfy":search->type==SOLVE_MINIMIZE?"minimize":"maximize";
+}
+
+void ModelAnalysis::write(ostream& out) const{
+	long long nbconstraints = 0;
+	for(map<string, long long>::const_iterator i=constraints.begin(); i!=constraints.end(); ++i){
+		nbconstraints += (*i).second;
+	}
+
+	// Every constant is an INTVAR statement, every token a number and a space
+	long long estvars = variables[VAR_BOOL]+variables[VAR_INT]+setmembers+constants.size()+auxvars;
+	long long eststatements = statements+constants.size();
+	long long esttokens = tokens+5*constants.size();
+	int digits = 1;
+	for(long long i=estvars; i>=10; i /= 10){
+		digits++;
+	}
+
+	long long maxdegree = 0, isolated = 0;
+	vector<long long> componentsizes(parents.size(), 0);
+	for(unsigned int i=0; i<parents.size(); ++i){
+		maxdegree = max(maxdegree, (long long)degrees[i]);
+		if(degrees[i]==0){
+			isolated++;
+		}
+		int root = i;
+		while(parents[root]!=root){
+			root = parents[root];
+		}
+		componentsizes[root]++;
+	}
+	long long components = parents.size()-count(componentsizes.begin(), componentsizes.end(), 0LL);
+	long long largestcomponent = componentsizes.empty()?0:*max_element(componentsizes.begin(), componentsizes.end());
+
+	out <<fixed <<setprecision(6);
+	out <<"{\"variables\": {";
+	for(int i=0; i<VAR_ARRAY; ++i){
+		out <<"\"" <<vartypenames[i] <<"\": " <<variables[i] <<", ";
+	}
+	out <<"\"parameters\": " <<parameters <<"}, \"intdomains\": {";
+	for(int i=0; i<NBDOMAINSIZES; ++i){
+		out <<(i==0?"":", ") <<"\"" <<domainsizenames[i] <<"\": " <<domains[i];
+	}
+	out <<"}, \"arrays\": {\"count\": " <<arrays <<", \"elements\": " <<arrayelements <<", \"largest\": " <<largestarray <<"}";
+	out <<", \"constraints\": {\"total\": " <<nbconstraints <<", \"unsupported\": " <<unsupported <<", \"types\": {";
+	for(map<string, long long>::const_iterator i=constraints.begin(); i!=constraints.end(); ++i){
+		out <<(i==constraints.begin()?"":", ") <<"\"" <<(*i).first <<"\": " <<(*i).second;
+	}
+	out <<"}}, \"solve\": \"" <<solve <<"\"";
+	out <<", \"estimate\": {\"variables\": " <<estvars <<", \"auxvars\": " <<auxvars <<", \"statements\": " <<eststatements
+		<<", \"bytes\": " <<esttokens*(digits+1) <<"}";
+	out <<", \"graph\": {\"nodes\": " <<parents.size() <<", \"incidences\": " <<incidences
+		<<", \"maxdegree\": " <<maxdegree <<", \"meandegree\": " <<(parents.empty()?0.0:(double)incidences/parents.size())
+		<<", \"isolated\": " <<isolated
+		<<", \"maxarity\": " <<largestarity <<", \"meanarity\": " <<(nbconstraints==0?0.0:(double)incidences/nbconstraints)
+		<<", \"components\": " <<components <<", \"largestcomponent\": " <<largestcomponent <<"}}\n";
+}
+
+void FZ::analyzeModel(bool readfromstdin, const string& inputfile, ostream& out){
+	FILE* in = readfromstdin?stdin:fopen(inputfile.c_str(), "r");
+	if(in==NULL){
+		throw fzexception("File could not be opened, aborting.\n");
+	}
+	ModelAnalysis analysis;
+	int result = 0;
+	{
+		MemoryScope ast(MEM_AST);
+		try{
+			string json;
+			if(readJson(in, json)){
+				parseJson(json.data(), json.data()+json.size(), analysis);
+			}else{
+				ParseContext context(in, &analysis);
+				result = parse(context);
+			}
+		}catch(...){
+			if(!readfromstdin){
+				fclose(in);
+			}
+			throw;
+		}
+	}
+	if(!readfromstdin){
+		fclose(in);
+	}
+	if(result!=0){
+		throw fzexception("Unspecified parsing error.\n");
+	}
+	analysis.write(out);
+}
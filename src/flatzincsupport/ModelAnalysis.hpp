@@ -0,0 +1,71 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef MODELANALYSIS_HPP_
+#define MODELANALYSIS_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <ostream>
+
+#include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/ParseContext.hpp"
+
+namespace FZ{
+
+enum DOMAIN_SIZE { DOMAIN_0, DOMAIN_1, DOMAIN_2, DOMAIN_8, DOMAIN_64, DOMAIN_1024, DOMAIN_LARGER, DOMAIN_UNBOUNDED, NBDOMAINSIZES };
+
+/**
+ * The structure of a model, gathered while it is parsed instead of translated.
+ * The graph has a node per decision variable and connects the variables of each constraint.
+ * The size of the translation is estimated per constraint, without resolving the arguments.
+ */
+class ModelAnalysis: public ItemHandler{
+private:
+	long long variables[VAR_ARRAY], parameters;
+	long long domains[NBDOMAINSIZES];
+	long long arrays, arrayelements, largestarray;
+	std::map<std::string, long long> constraints;	// By name
+	long long unsupported;
+	std::string solve;
+
+	long long setmembers, auxvars, statements, tokens;
+	std::set<int> constants;	// The integers that are scalar constraint arguments, each is one variable
+
+	std::map<std::string, int> nodes;						// Variable to its node
+	std::map<std::string, std::vector<int> > arraynodes;	// Array to the node of each element, -1 for a constant
+	std::vector<int> parents;	// Union-find forest of the components
+	std::vector<int> degrees;	// The number of constraints of each node
+	long long incidences, largestarity;
+
+	int createNode();
+	int findComponent(int node);
+	void addVariable(VAR_TYPE type, const Var* domain, int count);
+	int getNode(const Expression& expr) const;
+	int addArgument(const Expression& expr, std::vector<int>& argnodes);
+	void estimate(int type, const std::vector<int>& sizes);
+
+public:
+	ModelAnalysis();
+
+	void start();
+	void add(Var* var);
+	void add(Constraint* constraint);
+	void add(Search* search);
+
+	void write(std::ostream& out) const;	// As JSON
+};
+
+// Parses the model from stdin or the file and writes its analysis as JSON
+void analyzeModel(bool readfromstdin, const std::string& inputfile, std::ostream& out);
+
+}
+
+#endif /* MODELANALYSIS_HPP_ */
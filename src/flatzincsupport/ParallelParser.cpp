@@ -0,0 +1,218 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/ParallelParser.hpp"
+
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/ParseContext.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+namespace{
+
+// A chunk ends at the first item boundary after this many bytes
+const size_t CHUNKSIZE = 4*1024*1024;
+
+struct Chunk{
+	const char* begin, *end;
+	bool parsed;
+	ParseContext* context;
+	exception_ptr error;
+
+	Chunk(const char* begin, const char* end): begin(begin), end(end), parsed(false), context(NULL){}
+};
+
+// Returns the position after the first ';' that ends an item, at or after position
+const char* findItemEnd(const char* input, const char* position, const char* end){
+	// String literals and comments end at the end of their line, so a line starts outside of them
+	if(position>input && position[-1]!='\n'){
+		position = (const char*)memchr(position, '\n', end-position);
+		if(position==NULL){
+			return end;
+		}
+		++position;
+	}
+	bool instring = false;
+	for(; position<end; ++position){
+		char c = *position;
+		if(instring){
+			instring = c!='"' && c!='\n';
+		}else if(c=='"'){
+			instring = true;
+		}else if(c=='%'){
+			position = (const char*)memchr(position, '\n', end-position);
+			if(position==NULL){
+				return end;
+			}
+		}else if(c==';'){
+			return position+1;
+		}
+	}
+	return end;
+}
+
+// Hands out the chunks to the threads, at most window chunks ahead of the one being translated
+class ChunkParser{
+private:
+	vector<Chunk>& chunks;
+	size_t window;
+	mutex lock;
+	condition_variable changed;
+	size_t next, translated;
+	bool stopped;
+
+public:
+	ChunkParser(vector<Chunk>& chunks, size_t window): chunks(chunks), window(window), next(0), translated(0), stopped(false){}
+	~ChunkParser(){
+		for(vector<Chunk>::const_iterator i=chunks.begin(); i<chunks.end(); ++i){
+			delete((*i).context);
+		}
+	}
+
+	void work(){
+		MemoryScope ast(MEM_AST);
+		unique_lock<mutex> guard(lock);
+		while(true){
+			while(!stopped && next<chunks.size() && next>=translated+window){
+				changed.wait(guard);
+			}
+			if(stopped || next>=chunks.size()){
+				return;
+			}
+			Chunk& chunk = chunks[next++];
+			guard.unlock();
+			ParseContext* context = new ParseContext(chunk.begin, chunk.end);
+			exception_ptr error;
+			try{
+				if(parse(*context)!=0){
+					throw fzexception("Unspecified parsing error.\n");
+				}
+			}catch(...){
+				error = current_exception();
+			}
+			guard.lock();
+			chunk.context = context;
+			chunk.error = error;
+			chunk.parsed = true;
+			changed.notify_all();
+		}
+	}
+
+	// Waits until the chunk is parsed, and throws its parsing error if any
+	vector<Item>& getItems(size_t index){
+		unique_lock<mutex> guard(lock);
+		while(!chunks[index].parsed){
+			changed.wait(guard);
+		}
+		if(chunks[index].error){
+			rethrow_exception(chunks[index].error);
+		}
+		return chunks[index].context->getItems();
+	}
+
+	void release(size_t index){
+		lock_guard<mutex> guard(lock);
+		delete(chunks[index].context);
+		chunks[index].context = NULL;
+		translated = index+1;
+		changed.notify_all();
+	}
+
+	void stop(){
+		lock_guard<mutex> guard(lock);
+		stopped = true;
+		changed.notify_all();
+	}
+};
+
+// The declarations precede the constraints, which precede the solve item
+enum MODELPART { PART_VARS, PART_CONSTRAINTS, PART_SOLVED };
+
+void addItem(Item item, MODELPART& part, ItemHandler& handler){
+	if(item.var!=NULL){
+		if(part!=PART_VARS){
+			delete(item.var);
+			throw fzexception("Parsing error: a variable is declared after the constraints.\n");
+		}
+		handler.add(item.var);
+		delete(item.var);
+	}else if(item.constraint!=NULL){
+		if(part==PART_SOLVED){
+			delete(item.constraint);
+			throw fzexception("Parsing error: a constraint follows the solve item.\n");
+		}
+		part = PART_CONSTRAINTS;
+		handler.add(item.constraint);
+		delete(item.constraint);
+	}else{
+		if(part==PART_SOLVED){
+			delete(item.search);
+			throw fzexception("Parsing error: the model has more than one solve item.\n");
+		}
+		part = PART_SOLVED;
+		handler.add(item.search);
+		delete(item.search);
+	}
+}
+
+void joinAll(vector<thread>& threads){
+	for(vector<thread>::iterator i=threads.begin(); i<threads.end(); ++i){
+		(*i).join();
+	}
+}
+
+}
+
+void FZ::parseChunks(const char* input, size_t size, int nbthreads, ItemHandler& handler){
+	vector<Chunk> chunks;
+	const char* end = input+size;
+	for(const char* begin = input; begin<end;){
+		const char* chunkend = (size_t)(end-begin)>CHUNKSIZE?findItemEnd(input, begin+CHUNKSIZE, end):end;
+		chunks.push_back(Chunk(begin, chunkend));
+		begin = chunkend;
+	}
+
+	ChunkParser parser(chunks, 2*nbthreads);
+	vector<thread> threads;
+	for(int i=0; i<nbthreads && i<(int)chunks.size(); ++i){
+		threads.push_back(thread(&ChunkParser::work, &parser));
+	}
+	try{
+		handler.start();
+		MODELPART part = PART_VARS;
+		for(size_t i=0; i<chunks.size(); ++i){
+			vector<Item>& items = parser.getItems(i);
+			for(vector<Item>::iterator j=items.begin(); j<items.end(); ++j){
+				Item item = *j;
+				(*j).var = NULL;
+				(*j).constraint = NULL;
+				(*j).search = NULL;
+				addItem(item, part, handler);
+			}
+			parser.release(i);
+		}
+		if(part!=PART_SOLVED){
+			throw fzexception("Parsing error: the model has no solve item.\n");
+		}
+	}catch(...){
+		parser.stop();
+		joinAll(threads);
+		throw;
+	}
+	joinAll(threads);
+}
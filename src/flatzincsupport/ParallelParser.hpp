@@ -0,0 +1,28 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef PARALLELPARSER_HPP_
+#define PARALLELPARSER_HPP_
+
+#include <cstddef>
+
+namespace FZ{
+
+class ItemHandler;
+
+/**
+ * Splits the input at item boundaries into chunks, which are lexed and parsed on nbthreads threads.
+ * Meanwhile the items of the parsed chunks are given to the handler in input order, so only the chunks
+ * between the one being translated and the last one being parsed are in memory.
+ * The items may be in any order within a chunk, the order of the model is checked when they are handed over.
+ */
+void parseChunks(const char* input, size_t size, int nbthreads, ItemHandler& handler);
+
+}
+
+#endif /* PARALLELPARSER_HPP_ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/ParseContext.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "flatzincsupport/FZDatastructs.hpp"
+#include "flatzincsupport/flatzincparser.h"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+ParseContext::ParseContext(FILE* in, ItemHandler* handler)
+		: in(in), position(NULL), end(NULL), starttoken(START_MODEL), handler(handler){
+}
+
+ParseContext::ParseContext(const char* begin, const char* end)
+		: in(NULL), position(begin), end(end), starttoken(START_ITEMS), handler(NULL){
+}
+
+ParseContext::~ParseContext(){
+	for(vector<Item>::const_iterator i=items.begin(); i<items.end(); ++i){
+		delete((*i).var);
+		delete((*i).constraint);
+		delete((*i).search);
+	}
+}
+
+size_t ParseContext::read(char* buffer, size_t size){
+	if(in!=NULL){
+		size_t count = fread(buffer, 1, size, in);
+		if(count==0 && ferror(in)){
+			throw fzexception("The input could not be read.\n");
+		}
+		return count;
+	}
+	size_t count = min(size, (size_t)(end-position));
+	memcpy(buffer, position, count);
+	position += count;
+	return count;
+}
+
+int ParseContext::getStartToken(){
+	int token = starttoken;
+	starttoken = 0;
+	return token;
+}
+
+void ParseContext::start(){
+	handler->start();
+}
+
+void ParseContext::add(Var* var){
+	if(handler==NULL){
+		Item item = {var, NULL, NULL};
+		items.push_back(item);
+		return;
+	}
+	handler->add(var);
+	delete(var);
+}
+
+void ParseContext::add(Constraint* constraint){
+	if(handler==NULL){
+		Item item = {NULL, constraint, NULL};
+		items.push_back(item);
+		return;
+	}
+	handler->add(constraint);
+	delete(constraint);
+}
+
+void ParseContext::add(Search* search){
+	if(handler==NULL){
+		Item item = {NULL, NULL, search};
+		items.push_back(item);
+		return;
+	}
+	handler->add(search);
+	delete(search);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef PARSECONTEXT_HPP_
+#define PARSECONTEXT_HPP_
+
+#include <cstdio>
+#include <vector>
+
+namespace FZ{
+
+class Var;
+struct Constraint;
+struct Search;
+
+// Gets the items of a model in input order, the caller deletes them afterwards
+class ItemHandler{
+public:
+	virtual ~ItemHandler(){}
+
+	virtual void start() = 0;
+	virtual void add(Var* var) = 0;
+	virtual void add(Constraint* constraint) = 0;
+	virtual void add(Search* search) = 0;
+};
+
+// One parsed item, exactly one of the pointers is set
+struct Item{
+	Var* var;
+	Constraint* constraint;
+	Search* search;
+};
+
+/**
+ * The state of one run of the reentrant lexer and parser.
+ * A whole model goes to the handler while it is parsed, the items of a chunk are kept in input order,
+ * so chunks can be parsed on several threads and be translated afterwards.
+ */
+class ParseContext{
+private:
+	FILE* in;					// NULL if the input is the memory between position and end
+	const char* position, *end;
+	int starttoken;				// Tells the parser what the input is, returned as the first token
+	ItemHandler* handler;		// NULL if the items are kept
+	std::vector<Item> items;
+
+public:
+	ParseContext(FILE* in, ItemHandler* handler);	// Starts with the token of a whole model
+	ParseContext(const char* begin, const char* end);	// Starts with the token of a chunk
+	~ParseContext();
+
+	size_t read(char* buffer, size_t size);
+	int getStartToken();
+
+	void start();
+	void add(Var* var);
+	void add(Constraint* constraint);
+	void add(Search* search);
+
+	// The items of a chunk, which the caller takes over
+	std::vector<Item>& getItems() { return items; }
+};
+
+// Lexes and parses the input of the context, returns 0 on success
+int parse(ParseContext& context);
+
+}
+
+// The reentrant lexer of flatzinclexer.lpp
+int fzlex_init_extra(FZ::ParseContext* context, void** scanner);
+int fzlex_destroy(void* scanner);
+
+#endif /* PARSECONTEXT_HPP_ */
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/Renumbering.hpp"
+
+#include <algorithm>
+
+#include "flatzincsupport/StatementBuffer.hpp"
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+struct ByDegree{
+	const vector<int>& varstart;
+	ByDegree(const vector<int>& varstart): varstart(varstart){}
+	bool operator()(int first, int second) const{
+		return varstart[first+1]-varstart[first] < varstart[second+1]-varstart[second];
+	}
+};
+
+void FZ::getLocalityOrder(const vector<const StatementBuffer*>& buffers, int maxvar, RENUMBERING method, vector<int>& names){
+	// The incidence of statements and variables, both ways, as offsets into one flat list
+	vector<int> statementstart(1, 0), statementvars;
+	vector<int> degree(maxvar+2, 0);
+	for(vector<const StatementBuffer*>::const_iterator b=buffers.begin(); b<buffers.end(); ++b){
+		const StatementBuffer& buffer = **b;
+		for(unsigned int s=0; s<buffer.size(); s=buffer.next(s)){
+			if(buffer.getNbVars(s)==0){
+				continue;
+			}
+			const int* vars = buffer.getVars(s);
+			for(const int* i=vars; i<vars+buffer.getNbVars(s); ++i){
+				int var = *i<0?-*i:*i;
+				if(var>maxvar){ throw fzexception("Unknown variable in the output.\n"); }
+				statementvars.push_back(var);
+				degree[var]++;
+			}
+			statementstart.push_back(statementvars.size());
+		}
+	}
+	int nbstatements = statementstart.size()-1;
+	vector<int> varstart(maxvar+2, 0);
+	for(int v=1; v<=maxvar; ++v){
+		varstart[v+1] = varstart[v]+degree[v];
+	}
+	vector<int> varstatements(statementvars.size());
+	vector<int> filled(varstart.begin(), varstart.end()-1);
+	for(int s=0; s<nbstatements; ++s){
+		for(int i=statementstart[s]; i<statementstart[s+1]; ++i){
+			varstatements[filled[statementvars[i]]++] = s;
+		}
+	}
+
+	ByDegree bydegree(varstart);
+	vector<int> roots;
+	for(int v=1; v<=maxvar; ++v){
+		if(degree[v]>0){
+			roots.push_back(v);
+		}
+	}
+	if(method==RENUMBER_RCM){
+		stable_sort(roots.begin(), roots.end(), bydegree);
+	}
+
+	vector<int> order;
+	order.reserve(maxvar);
+	vector<bool> visitedvar(maxvar+1, false), visitedstatement(nbstatements, false);
+	for(vector<int>::const_iterator r=roots.begin(); r<roots.end(); ++r){
+		if(visitedvar[*r]){
+			continue;
+		}
+		visitedvar[*r] = true;
+		order.push_back(*r);
+		// order doubles as the queue
+		for(unsigned int next=order.size()-1; next<order.size(); ++next){
+			int var = order[next];
+			unsigned int neighbours = order.size();
+			for(int i=varstart[var]; i<varstart[var+1]; ++i){
+				int s = varstatements[i];
+				if(visitedstatement[s]){
+					continue;
+				}
+				visitedstatement[s] = true;
+				for(int j=statementstart[s]; j<statementstart[s+1]; ++j){
+					if(!visitedvar[statementvars[j]]){
+						visitedvar[statementvars[j]] = true;
+						order.push_back(statementvars[j]);
+					}
+				}
+			}
+			if(method==RENUMBER_RCM){
+				stable_sort(order.begin()+neighbours, order.end(), bydegree);
+			}
+		}
+	}
+	if(method==RENUMBER_RCM){
+		reverse(order.begin(), order.end());
+	}
+	for(int v=1; v<=maxvar; ++v){
+		if(degree[v]==0){
+			order.push_back(v);
+		}
+	}
+
+	names.assign(maxvar+1, 0);
+	for(unsigned int i=0; i<order.size(); ++i){
+		names[order[i]] = i+1;
+	}
+}
+
+void FZ::compactNumbering(const vector<const StatementBuffer*>& buffers, vector<int>& names){
+	int maxvar = names.size()-1;
+	vector<bool> used(maxvar+1, false);
+	for(vector<const StatementBuffer*>::const_iterator b=buffers.begin(); b<buffers.end(); ++b){
+		const StatementBuffer& buffer = **b;
+		for(unsigned int s=0; s<buffer.size(); s=buffer.next(s)){
+			const int* vars = buffer.getVars(s);
+			for(const int* i=vars; i<vars+buffer.getNbVars(s); ++i){
+				int var = *i<0?-*i:*i;
+				if(var>maxvar){ throw fzexception("Unknown variable in the output.\n"); }
+				used[var] = true;
+			}
+		}
+	}
+
+	// The variables by their current name
+	vector<int> order(maxvar+1, 0);
+	for(int v=1; v<=maxvar; ++v){
+		order[names[v]] = v;
+	}
+	int next = 1;
+	for(int i=1; i<=maxvar; ++i){
+		int var = order[i];
+		names[var] = used[var]?next++:0;
+	}
+}
+
+void FZ::renameVariables(StatementBuffer& buffer, const vector<int>& names){
+	for(unsigned int s=0; s<buffer.size(); s=buffer.next(s)){
+		int* vars = buffer.getVars(s);
+		for(int* i=vars; i<vars+buffer.getNbVars(s); ++i){
+			*i = *i<0?-names[-*i]:names[*i];
+		}
+	}
+}
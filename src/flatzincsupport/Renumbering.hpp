@@ -0,0 +1,39 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef RENUMBERING_HPP_
+#define RENUMBERING_HPP_
+
+#include <vector>
+#include "flatzincsupport/TranslationOptions.hpp"
+
+namespace FZ{
+
+class StatementBuffer;
+
+/**
+ * Numbers the variables 1..maxvar in breadth first order over the statements they occur in, so variables
+ * sharing statements get nearby numbers. RENUMBER_RCM visits neighbours by increasing number of statements,
+ * starting each component from a variable in the fewest statements, and reverses the order (reverse Cuthill-McKee).
+ * Variables without statements keep their relative order after all others.
+ * names[v] is the new number of variable v.
+ */
+void getLocalityOrder(const std::vector<const StatementBuffer*>& buffers, int maxvar, RENUMBERING method, std::vector<int>& names);
+
+/**
+ * Keeps the order of names but numbers only the variables that occur in the buffers, consecutively from 1.
+ * The others get 0.
+ */
+void compactNumbering(const std::vector<const StatementBuffer*>& buffers, std::vector<int>& names);
+
+// Replaces every variable v in the buffer by names[v], keeping its sign
+void renameVariables(StatementBuffer& buffer, const std::vector<int>& names);
+
+}
+
+#endif /* RENUMBERING_HPP_ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/SearchHints.hpp"
+
+using namespace std;
+using namespace FZ;
+
+vector<SearchHint>& FZ::getSearchHints(){
+	static vector<SearchHint> hints;
+	return hints;
+}
+
+void FZ::renameSearchHints(const vector<int>& names){
+	vector<SearchHint>& hints = getSearchHints();
+	for(vector<SearchHint>::iterator i=hints.begin(); i<hints.end(); ++i){
+		vector<int> renamed;
+		renamed.reserve((*i).vars.size());
+		for(vector<int>::const_iterator j=(*i).vars.begin(); j<(*i).vars.end(); ++j){
+			if(names[*j]!=0){
+				renamed.push_back(names[*j]);
+			}
+		}
+		(*i).vars.swap(renamed);
+	}
+}
+
+void FZ::writeSearchHints(ostream& out, const vector<SearchHint>& hints){
+	for(vector<SearchHint>::const_iterator i=hints.begin(); i<hints.end(); ++i){
+		out <<((*i).booleans?"bool_search ":"int_search ") <<(*i).varselect <<" " <<(*i).valselect <<" " <<(*i).strategy <<" ";
+		for(vector<int>::const_iterator j=(*i).vars.begin(); j<(*i).vars.end(); ++j){
+			out <<*j <<" ";
+		}
+		out <<"0\n";
+	}
+}
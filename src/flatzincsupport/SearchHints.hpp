@@ -0,0 +1,39 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef SEARCHHINTS_HPP_
+#define SEARCHHINTS_HPP_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace FZ{
+
+// An int_search or bool_search annotation of the solve item, with its variables as ECNF variables
+struct SearchHint{
+	bool booleans;	// bool_search, the variables are literals
+	std::vector<int> vars;
+	std::string varselect, valselect, strategy;
+};
+
+// In the order in which they should be tried, seq_search is flattened
+std::vector<SearchHint>& getSearchHints();
+
+// Variable v becomes names[v], variables that are not in the output (name 0) are left out
+void renameSearchHints(const std::vector<int>& names);
+
+/**
+ * The text sidecar, one line per hint: "int_search varselect valselect strategy vars 0" or the same for bool_search.
+ * The variables are in decision order, for bool_search indomain_max prefers true and indomain_min false.
+ */
+void writeSearchHints(std::ostream& out, const std::vector<SearchHint>& hints);
+
+}
+
+#endif /* SEARCHHINTS_HPP_ */
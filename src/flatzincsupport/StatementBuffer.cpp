@@ -0,0 +1,160 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/StatementBuffer.hpp"
+
+using namespace std;
+using namespace FZ;
+
+void StatementBuffer::open(STATEMENT type, unsigned int nbvars, unsigned int nbconstants){
+	data.push_back(type);
+	data.push_back(nbvars);
+	data.push_back(nbconstants);
+}
+
+void StatementBuffer::addUnit(int lit){
+	open(ECNF_CLAUSE, 1, 0);
+	data.push_back(lit);
+}
+
+void StatementBuffer::addBinary(int lit, int lit2){
+	open(ECNF_CLAUSE, 2, 0);
+	data.push_back(lit);
+	data.push_back(lit2);
+}
+
+void StatementBuffer::addStatement(const StatementBuffer& buffer, unsigned int position){
+	data.insert(data.end(), buffer.data.begin()+position, buffer.data.begin()+buffer.next(position));
+}
+
+void StatementBuffer::replay(EcnfSink& sink) const{
+	for(unsigned int i=0; i<size(); i=next(i)){
+		replay(sink, i);
+	}
+}
+
+void StatementBuffer::replay(EcnfSink& sink, unsigned int position) const{
+	const int* vars = getVars(position);
+	unsigned int nbvars = getNbVars(position);
+	const int* constants = getConstants(position);
+	unsigned int nbconstants = getNbConstants(position);
+	switch(getType(position)){
+	case ECNF_CLAUSE:
+		sink.addClause(Span<int>(vars, nbvars));
+		break;
+	case ECNF_EQUIV:
+		sink.addEquivalence(vars[0], constants[0]!=0, Span<int>(vars+1, nbvars-1));
+		break;
+	case ECNF_RULE:
+		sink.addRule(constants[1], vars[0], constants[0]!=0, Span<int>(vars+1, nbvars-1));
+		break;
+	case ECNF_INTVAR:
+		sink.addIntVar(vars[0], constants[0], constants[1]);
+		break;
+	case ECNF_INTVARDOM:
+		sink.addIntVar(vars[0], Span<int>(constants, nbconstants));
+		break;
+	case ECNF_BINTRI:
+		sink.addComparison(vars[0], vars[1], (COMPARISON)constants[0], constants[1]);
+		break;
+	case ECNF_BINTRT:
+		sink.addVarComparison(vars[0], vars[1], (COMPARISON)constants[0], vars[2]);
+		break;
+	case ECNF_SUMSTSIRI:
+		sink.addLinear(vars[0], Span<int>(vars+1, nbvars-1), Span<int>(constants+2, nbconstants-2), (COMPARISON)constants[0], constants[1]);
+		break;
+	case ECNF_SET:
+		sink.addSet(constants[0], Span<int>(vars, nbvars), Span<int>(constants+1, nbconstants-1));
+		break;
+	case ECNF_AGGREGATE:
+		sink.addAggregate((AGGREGATE)constants[0], vars[0], constants[1], constants[2]!=0, constants[3]);
+		break;
+	case ECNF_MNMLIST:
+		sink.addMinimize(Span<int>(vars, nbvars));
+		break;
+	}
+}
+
+void StatementBuffer::addClause(Span<int> lits){
+	open(ECNF_CLAUSE, lits.size(), 0);
+	data.insert(data.end(), lits.begin(), lits.end());
+}
+
+void StatementBuffer::addEquivalence(int head, bool conj, Span<int> body){
+	open(ECNF_EQUIV, body.size()+1, 1);
+	data.push_back(head);
+	data.insert(data.end(), body.begin(), body.end());
+	data.push_back(conj?1:0);
+}
+
+void StatementBuffer::addRule(int definition, int head, bool conj, Span<int> body){
+	open(ECNF_RULE, body.size()+1, 2);
+	data.push_back(head);
+	data.insert(data.end(), body.begin(), body.end());
+	data.push_back(conj?1:0);
+	data.push_back(definition);
+}
+
+void StatementBuffer::addIntVar(int var, int lower, int upper){
+	open(ECNF_INTVAR, 1, 2);
+	data.push_back(var);
+	data.push_back(lower);
+	data.push_back(upper);
+}
+
+void StatementBuffer::addIntVar(int var, Span<int> domain){
+	open(ECNF_INTVARDOM, 1, domain.size());
+	data.push_back(var);
+	data.insert(data.end(), domain.begin(), domain.end());
+}
+
+void StatementBuffer::addComparison(int head, int var, COMPARISON op, int value){
+	open(ECNF_BINTRI, 2, 2);
+	data.push_back(head);
+	data.push_back(var);
+	data.push_back(op);
+	data.push_back(value);
+}
+
+void StatementBuffer::addVarComparison(int head, int var, COMPARISON op, int var2){
+	open(ECNF_BINTRT, 3, 1);
+	data.push_back(head);
+	data.push_back(var);
+	data.push_back(var2);
+	data.push_back(op);
+}
+
+void StatementBuffer::addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound){
+	open(ECNF_SUMSTSIRI, vars.size()+1, weights.size()+2);
+	data.push_back(head);
+	data.insert(data.end(), vars.begin(), vars.end());
+	data.push_back(op);
+	data.push_back(bound);
+	data.insert(data.end(), weights.begin(), weights.end());
+}
+
+void StatementBuffer::addSet(int setid, Span<int> lits, Span<int> weights){
+	open(ECNF_SET, lits.size(), weights.size()+1);
+	data.insert(data.end(), lits.begin(), lits.end());
+	data.push_back(setid);
+	data.insert(data.end(), weights.begin(), weights.end());
+}
+
+void StatementBuffer::addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound){
+	open(ECNF_AGGREGATE, 1, 4);
+	data.push_back(head);
+	data.push_back(type);
+	data.push_back(setid);
+	data.push_back(upper?1:0);
+	data.push_back(bound);
+}
+
+void StatementBuffer::addMinimize(Span<int> lits){
+	open(ECNF_MNMLIST, lits.size(), 0);
+	data.insert(data.end(), lits.begin(), lits.end());
+}
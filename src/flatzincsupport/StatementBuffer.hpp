@@ -0,0 +1,71 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef STATEMENTBUFFER_HPP_
+#define STATEMENTBUFFER_HPP_
+
+#include <vector>
+#include "flatzincsupport/EcnfSink.hpp"
+
+namespace FZ{
+
+enum STATEMENT { ECNF_CLAUSE, ECNF_EQUIV, ECNF_RULE, ECNF_INTVAR, ECNF_INTVARDOM, ECNF_BINTRI, ECNF_BINTRT,
+	ECNF_SUMSTSIRI, ECNF_SET, ECNF_AGGREGATE, ECNF_MNMLIST };
+
+/**
+ * The translated statements, kept until the passes over the whole theory are done and then replayed into the sink.
+ * A statement is its type, its number of variables and of constants, its variables and its constants, so a pass can
+ * rename or count the variables without knowing the statement:
+ * Clause, Set and Mnmlist have only literals (Set has its setid and the weights as constants),
+ * Equiv has head and body with conj, a rule head and body with conj and definition,
+ * INTVAR and INTVARDOM the variable with its bounds or values, BINTRI head and var with op and value,
+ * BINTRT head, var and var2 with op, SUMSTSIRI head and vars with op, bound and weights,
+ * and an aggregate its head with type, setid, upper and bound.
+ */
+class StatementBuffer: public EcnfSink{
+private:
+	std::vector<int> data;
+
+	void open(STATEMENT type, unsigned int nbvars, unsigned int nbconstants);
+
+public:
+	// Statements are addressed by their position, from 0 while position<size(), to next(position)
+	unsigned int size() const { return data.size(); }
+	unsigned int next(unsigned int position) const { return position+3+data[position+1]+data[position+2]; }
+	STATEMENT getType(unsigned int position) const { return (STATEMENT)data[position]; }
+	unsigned int getNbVars(unsigned int position) const { return data[position+1]; }
+	int* getVars(unsigned int position) { return &data[position+3]; }
+	const int* getVars(unsigned int position) const { return &data[position+3]; }
+	unsigned int getNbConstants(unsigned int position) const { return data[position+2]; }
+	const int* getConstants(unsigned int position) const { return &data[position+3+data[position+1]]; }
+
+	void addUnit(int lit);
+	void addBinary(int lit, int lit2);
+	// Copies the statement at position of buffer
+	void addStatement(const StatementBuffer& buffer, unsigned int position);
+	void swap(StatementBuffer& buffer) { data.swap(buffer.data); }
+
+	void replay(EcnfSink& sink) const;
+	void replay(EcnfSink& sink, unsigned int position) const;
+
+	void addClause(Span<int> lits);
+	void addEquivalence(int head, bool conj, Span<int> body);
+	void addRule(int definition, int head, bool conj, Span<int> body);
+	void addIntVar(int var, int lower, int upper);
+	void addIntVar(int var, Span<int> domain);
+	void addComparison(int head, int var, COMPARISON op, int value);
+	void addVarComparison(int head, int var, COMPARISON op, int var2);
+	void addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound);
+	void addSet(int setid, Span<int> lits, Span<int> weights);
+	void addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound);
+	void addMinimize(Span<int> lits);
+};
+
+}
+
+#endif /* STATEMENTBUFFER_HPP_ */
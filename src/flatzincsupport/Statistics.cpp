@@ -0,0 +1,174 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/Statistics.hpp"
+
+#include <ctime>
+#include <cstring>
+#include <iomanip>
+
+#include "flatzincsupport/ConstraintTable.hpp"
+#include "flatzincsupport/StatementBuffer.hpp"
+
+using namespace std;
+using namespace FZ;
+
+extern const char* comparisons[];
+
+const char* phasenames[NBPHASES] = { "parsing", "declarations", "constraints", "output" };
+
+Statistics::Statistics(): enabled(false), constraintcount(getNbConstraintTypes(), 0), constrainttime(getNbConstraintTypes(), 0),
+		oneshotvars(0), truevars(0), falsevars(0){
+	for(int i=0; i<NBPHASES; ++i){
+		phasetime[i] = 0;
+	}
+}
+
+Statistics& FZ::getStatistics(){
+	static Statistics statistics;
+	return statistics;
+}
+
+double FZ::currentTime(){
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec+time.tv_nsec/1000000000.0;
+}
+
+void Statistics::addConstraint(int type, double time){
+	constraintcount[type]++;
+	constrainttime[type] += time;
+}
+
+namespace{
+
+// The characters of a number in the text output, with the space after it
+long long intBytes(int value){
+	long long bytes = value<0?3:2;
+	for(long long i=value<0?-(long long)value:value; i>=10; i /= 10){
+		bytes++;
+	}
+	return bytes;
+}
+
+long long intsBytes(const int* begin, const int* end){
+	long long bytes = 0;
+	for(const int* i=begin; i<end; ++i){
+		bytes += intBytes(*i);
+	}
+	return bytes;
+}
+
+}
+
+/**
+ * The statements are keyed as in the text output, clauses as "clause" and rules as "rule".
+ * Their size is what TextSink writes: the numbers, the keywords and separators of the statement and the closing "0\n".
+ */
+void Statistics::countStatements(const StatementBuffer& buffer){
+	for(unsigned int position=0; position<buffer.size(); position=buffer.next(position)){
+		const int* variables = buffer.getVars(position);
+		const int* constants = buffer.getConstants(position);
+		unsigned int nbconstants = buffer.getNbConstants(position);
+		long long bytes = intsBytes(variables, variables+buffer.getNbVars(position))+2;
+		const char* key = "";
+		switch(buffer.getType(position)){
+		case ECNF_CLAUSE:
+			key = "clause";
+			break;
+		case ECNF_EQUIV:
+			key = "Equiv";
+			bytes += 8;
+			break;
+		case ECNF_RULE:
+			key = "rule";
+			bytes += 4+intBytes(constants[1]);
+			break;
+		case ECNF_INTVAR:
+			key = "INTVAR";
+			bytes += 7+intsBytes(constants, constants+2);
+			break;
+		case ECNF_INTVARDOM:
+			key = "INTVARDOM";
+			bytes += 10+intsBytes(constants, constants+nbconstants);
+			break;
+		case ECNF_BINTRI:
+			key = "BINTRI";
+			bytes += 8+strlen(comparisons[constants[0]])+intBytes(constants[1]);
+			break;
+		case ECNF_BINTRT:
+			key = "BINTRT";
+			bytes += 8+strlen(comparisons[constants[0]]);
+			break;
+		case ECNF_SUMSTSIRI:
+			key = "SUMSTSIRI";
+			bytes += 13+strlen(comparisons[constants[0]])+intsBytes(constants+1, constants+nbconstants);
+			break;
+		case ECNF_SET:
+			key = nbconstants>1?"WSet":"Set";
+			bytes += strlen(key)+1+intsBytes(constants, constants+nbconstants);
+			break;
+		case ECNF_AGGREGATE:
+			key = constants[0]==AGG_CARD?"Card":"Sum";
+			bytes += strlen(key)+5+intBytes(constants[1])+intBytes(constants[3]);
+			break;
+		case ECNF_MNMLIST:
+			key = "Mnmlist";
+			bytes += 8;
+			break;
+		}
+		StatementStats& stats = statements[key];
+		stats.count++;
+		stats.bytes += bytes;
+	}
+}
+
+void Statistics::write(ostream& out, bool json) const{
+	out <<fixed <<setprecision(6);
+	if(json){
+		out <<"{\"phases\": {";
+		for(int i=0; i<NBPHASES; ++i){
+			out <<(i==0?"":", ") <<"\"" <<phasenames[i] <<"\": " <<phasetime[i];
+		}
+		out <<"}, \"constraints\": {";
+		bool first = true;
+		for(unsigned int i=0; i<constraintcount.size(); ++i){
+			if(constraintcount[i]==0){
+				continue;
+			}
+			out <<(first?"":", ") <<"\"" <<getSignature((CONSTRAINT_TYPE)i).name <<"\": {\"count\": " <<constraintcount[i] <<", \"time\": " <<constrainttime[i] <<"}";
+			first = false;
+		}
+		out <<"}, \"auxvars\": {\"oneshot\": " <<oneshotvars <<", \"true\": " <<truevars <<", \"false\": " <<falsevars <<"}";
+		out <<", \"statements\": {";
+		for(map<string, StatementStats>::const_iterator i=statements.begin(); i!=statements.end(); ++i){
+			out <<(i==statements.begin()?"":", ") <<"\"" <<(*i).first <<"\": {\"count\": " <<(*i).second.count <<", \"bytes\": " <<(*i).second.bytes <<"}";
+		}
+		out <<"}}\n";
+		return;
+	}
+
+	out <<"Phase times (s):\n";
+	for(int i=0; i<NBPHASES; ++i){
+		out <<"    " <<setw(20) <<left <<phasenames[i] <<right <<phasetime[i] <<"\n";
+	}
+	out <<"Constraints (count, time in s):\n";
+	for(unsigned int i=0; i<constraintcount.size(); ++i){
+		if(constraintcount[i]!=0){
+			out <<"    " <<setw(20) <<left <<getSignature((CONSTRAINT_TYPE)i).name <<right <<setw(12) <<constraintcount[i] <<"  " <<constrainttime[i] <<"\n";
+		}
+	}
+	out <<"Auxiliary variables:\n";
+	out <<"    " <<setw(20) <<left <<"oneshot" <<right <<setw(12) <<oneshotvars <<"\n";
+	out <<"    " <<setw(20) <<left <<"true" <<right <<setw(12) <<truevars <<"\n";
+	out <<"    " <<setw(20) <<left <<"false" <<right <<setw(12) <<falsevars <<"\n";
+	out <<"Output statements (count, bytes):\n";
+	for(map<string, StatementStats>::const_iterator i=statements.begin(); i!=statements.end(); ++i){
+		out <<"    " <<setw(20) <<left <<(*i).first <<right <<setw(12) <<(*i).second.count <<setw(14) <<(*i).second.bytes <<"\n";
+	}
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef STATISTICS_HPP_
+#define STATISTICS_HPP_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+namespace FZ{
+
+class StatementBuffer;
+
+enum PHASE { PHASE_PARSING, PHASE_DECLARATIONS, PHASE_CONSTRAINTS, PHASE_OUTPUT, NBPHASES };
+
+struct StatementStats{
+	long long count, bytes;
+	StatementStats(): count(0), bytes(0){}
+};
+
+/**
+ * Where the translation time goes and what drives the output size.
+ * Timing is only done when enabled, the counters are always kept.
+ */
+class Statistics{
+public:
+	bool enabled;
+	double phasetime[NBPHASES];
+	std::vector<long long> constraintcount;	// Indexed by CONSTRAINT_TYPE
+	std::vector<double> constrainttime;
+	long long oneshotvars, truevars, falsevars;
+	std::map<std::string, StatementStats> statements;	// By the keyword starting the statement
+
+	Statistics();
+
+	void addConstraint(int type, double time);
+	void countStatements(const StatementBuffer& buffer);
+
+	void write(std::ostream& out, bool json) const;
+};
+
+Statistics& getStatistics();
+double currentTime();
+
+}
+
+#endif /* STATISTICS_HPP_ */
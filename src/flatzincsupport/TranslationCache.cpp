@@ -0,0 +1,251 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/TranslationCache.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+inline unsigned long long rotate(unsigned long long x, int bits){
+	return (x<<bits) | (x>>(64-bits));
+}
+
+inline unsigned long long finalize(unsigned long long h){
+	h ^= h>>33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h>>33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h>>33;
+	return h;
+}
+
+// Two independent 64 bit lanes over 8 byte words
+void hashBytes(const char* data, size_t size, unsigned long long& h1, unsigned long long& h2){
+	size_t i = 0;
+	for(; i+8<=size; i+=8){
+		unsigned long long word;
+		memcpy(&word, data+i, 8);
+		h1 = rotate((h1^word)*0x9e3779b97f4a7c15ULL, 31);
+		h2 = rotate((h2+word)*0xc2b2ae3d27d4eb4fULL, 29);
+	}
+	unsigned long long word = 0;
+	memcpy(&word, data+i, size-i);
+	h1 = finalize((h1^word^size)*0x9e3779b97f4a7c15ULL);
+	h2 = finalize((h2+word+size)*0xc2b2ae3d27d4eb4fULL);
+}
+
+TranslationCache::TranslationCache(const string& directory, long long maxbytes)
+		: directory(directory), maxbytes(maxbytes), usable(false){
+	mkdir(directory.c_str(), 0777);
+	struct stat info;
+	usable = stat(directory.c_str(), &info)==0 && S_ISDIR(info.st_mode) && access(directory.c_str(), R_OK|W_OK|X_OK)==0;
+}
+
+string TranslationCache::getKey(const string& input, const string& salt) const{
+	unsigned long long h1 = 1, h2 = 2;
+	hashBytes(salt.data(), salt.size(), h1, h2);
+	hashBytes(input.data(), input.size(), h1, h2);
+	stringstream ss;
+	ss <<hex <<setfill('0') <<setw(16) <<h1 <<setw(16) <<h2;
+	return ss.str();
+}
+
+string TranslationCache::getPath(const string& key, const string& extension) const{
+	return directory+"/"+key+extension;
+}
+
+void writeAll(int fd, const char* data, size_t size){
+	while(size>0){
+		ssize_t written = write(fd, data, size);
+		if(written<0 && errno==EINTR){
+			continue;
+		}
+		if(written<=0){
+			throw fzexception("Could not write the output.\n");
+		}
+		data += written;
+		size -= written;
+	}
+}
+
+// Without copying through user space if the platform allows it
+void copyFile(int in, int out, size_t size){
+	size_t sent = 0;
+#ifdef __linux__
+	while(sent<size){
+		ssize_t result = sendfile(out, in, NULL, size-sent);
+		if(result<0 && errno==EINTR){
+			continue;
+		}
+		if(result<0 && sent==0 && (errno==EINVAL || errno==ENOSYS)){
+			break;
+		}
+		if(result<=0){
+			throw fzexception("Could not write the output.\n");
+		}
+		sent += result;
+	}
+#endif
+	if(sent==size){
+		return;
+	}
+	void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, in, 0);
+	if(data==MAP_FAILED){
+		throw fzexception("Could not read the cached output.\n");
+	}
+	writeAll(out, (const char*)data, size);
+	munmap(data, size);
+}
+
+bool TranslationCache::send(const string& key, const string& extension, int fd) const{
+	string path = getPath(key, extension);
+	int in = open(path.c_str(), O_RDONLY);
+	if(in<0){
+		return false;
+	}
+	struct stat info;
+	if(fstat(in, &info)!=0){
+		close(in);
+		return false;
+	}
+	try{
+		if(info.st_size>0){
+			copyFile(in, fd, info.st_size);
+		}
+	}catch(const fzexception&){
+		close(in);
+		throw;
+	}
+	close(in);
+	utimes(path.c_str(), NULL);
+	return true;
+}
+
+struct CachedFile{
+	time_t used;
+	long long size;
+	string path;
+
+	bool operator<(const CachedFile& other) const { return used<other.used; }
+};
+
+void TranslationCache::evict() const{
+	DIR* dir = opendir(directory.c_str());
+	if(dir==NULL){
+		return;
+	}
+	vector<CachedFile> files;
+	long long total = 0;
+	for(dirent* entry = readdir(dir); entry!=NULL; entry = readdir(dir)){
+		// Temporary entries start with a dot
+		if(entry->d_name[0]=='.'){
+			continue;
+		}
+		CachedFile file;
+		file.path = directory+"/"+entry->d_name;
+		struct stat info;
+		if(stat(file.path.c_str(), &info)!=0 || !S_ISREG(info.st_mode)){
+			continue;
+		}
+		file.used = info.st_mtime;
+		file.size = info.st_size;
+		total += file.size;
+		files.push_back(file);
+	}
+	closedir(dir);
+
+	sort(files.begin(), files.end());
+	for(vector<CachedFile>::const_iterator i=files.begin(); i<files.end() && total>maxbytes; ++i){
+		if(remove((*i).path.c_str())==0){
+			total -= (*i).size;
+		}
+	}
+}
+
+CacheEntry::CacheEntry(const TranslationCache& cache, const string& key, const string& extension)
+		: cache(cache), path(cache.getPath(key, extension)), committed(false){
+	stringstream ss;
+	ss <<cache.getPath("."+key, extension) <<"." <<getpid();
+	temppath = ss.str();
+	file.open(temppath.c_str(), ios::out | ios::binary | ios::trunc);
+}
+
+CacheEntry::~CacheEntry(){
+	if(!committed){
+		if(file.is_open()){
+			file.close();
+		}
+		remove(temppath.c_str());
+	}
+}
+
+void CacheEntry::commit(){
+	if(file.close()==NULL || rename(temppath.c_str(), path.c_str())!=0){
+		return;
+	}
+	committed = true;
+	cache.evict();
+}
+
+int TeeBuffer::overflow(int c){
+	if(c==EOF){
+		return 0;
+	}
+	if(second->sputc(c)==EOF){
+		secondcomplete = false;
+	}
+	return first->sputc(c);
+}
+
+streamsize TeeBuffer::xsputn(const char* s, streamsize n){
+	if(second->sputn(s, n)!=n){
+		secondcomplete = false;
+	}
+	return first->sputn(s, n);
+}
+
+int TeeBuffer::sync(){
+	if(second->pubsync()!=0){
+		secondcomplete = false;
+	}
+	return first->pubsync();
+}
+
+void FZ::readInput(bool readfromstdin, const string& inputfile, string& input){
+	FILE* in = readfromstdin?stdin:fopen(inputfile.c_str(), "r");
+	if(in==NULL){
+		throw fzexception("File could not be opened, aborting.\n");
+	}
+	char buffer[1<<16];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), in))>0){
+		input.append(buffer, read);
+	}
+	if(!readfromstdin){
+		fclose(in);
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef TRANSLATIONCACHE_HPP_
+#define TRANSLATIONCACHE_HPP_
+
+#include <string>
+#include <fstream>
+#include <streambuf>
+
+namespace FZ{
+
+/**
+ * On-disk cache of finished translations, keyed by a hash of the input bytes and of everything else that changes the output.
+ * Entries are written under a temporary name and renamed when complete, so concurrent translators never see partial entries.
+ * The modification time of an entry is its last use, the least recently used entries are evicted when the cache grows too large.
+ */
+class TranslationCache{
+private:
+	std::string directory;
+	long long maxbytes;
+	bool usable;
+
+public:
+	TranslationCache(const std::string& directory, long long maxbytes);
+
+	bool isUsable() const { return usable; }
+
+	// salt: the translator version and the options that change the output
+	std::string getKey(const std::string& input, const std::string& salt) const;
+	std::string getPath(const std::string& key, const std::string& extension) const;
+
+	// Copies the stored entry to fd and marks it as used, returns false if it is not cached
+	bool send(const std::string& key, const std::string& extension, int fd) const;
+
+	void evict() const;
+};
+
+/**
+ * A new cache entry, only stored if committed.
+ */
+class CacheEntry{
+private:
+	const TranslationCache& cache;
+	std::string path, temppath;
+	std::filebuf file;
+	bool committed;
+
+public:
+	CacheEntry(const TranslationCache& cache, const std::string& key, const std::string& extension);
+	~CacheEntry();
+
+	bool isOpen() const { return file.is_open(); }
+	std::streambuf* getBuffer() { return &file; }
+
+	void commit();
+};
+
+/**
+ * Writes everything to two buffers, used to store the output while writing it.
+ */
+class TeeBuffer: public std::streambuf{
+private:
+	std::streambuf* first;
+	std::streambuf* second;
+	bool secondcomplete;
+public:
+	TeeBuffer(std::streambuf* first, std::streambuf* second): first(first), second(second), secondcomplete(true){}
+
+	// False if some output could not be written to the second buffer
+	bool isSecondComplete() const { return secondcomplete; }
+protected:
+	int overflow(int c);
+	std::streamsize xsputn(const char* s, std::streamsize n);
+	int sync();
+};
+
+// Reads the whole input, throws if it could not be opened
+void readInput(bool readfromstdin, const std::string& inputfile, std::string& input);
+
+}
+
+#endif /* TRANSLATIONCACHE_HPP_ */
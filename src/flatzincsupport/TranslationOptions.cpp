@@ -0,0 +1,28 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/TranslationOptions.hpp"
+
+#include <sstream>
+
+using namespace std;
+using namespace FZ;
+
+TranslationOptions& FZ::getTranslationOptions(){
+	static TranslationOptions options;
+	return options;
+}
+
+// Part of the key, increase it with every change to the translation of a model so older cached translations are not used
+const int translationformat = 11;
+
+string TranslationOptions::getKey() const{
+	stringstream ss;
+	ss <<"format=" <<translationformat <<" renumber=" <<renumbering <<" compact=" <<compact <<" pbfusion=" <<pbfusion <<" expanddomains=" <<expanddomains <<" halfreify=" <<halfreify;
+	return ss.str();
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef TRANSLATIONOPTIONS_HPP_
+#define TRANSLATIONOPTIONS_HPP_
+
+#include <string>
+
+namespace FZ{
+
+enum RENUMBERING { RENUMBER_NONE, RENUMBER_BFS, RENUMBER_RCM };
+
+/**
+ * The options that change the output of the translation.
+ */
+struct TranslationOptions{
+	RENUMBERING renumbering;
+	bool compact;	// Number only the variables in the output, consecutively
+	bool pbfusion;	// Write linear constraints over bool2int channels as aggregates over the booleans
+	int expanddomains;	// Integer comparisons over at most this many values become clauses over value literals, 0 never
+	bool halfreify;	// Write an equivalence whose head occurs in one polarity as an implication
+
+	TranslationOptions(): renumbering(RENUMBER_NONE), compact(false), pbfusion(true), expanddomains(8), halfreify(true){}
+
+	// Differs for every combination of options that gives a different output
+	std::string getKey() const;
+};
+
+TranslationOptions& getTranslationOptions();
+
+}
+
+#endif /* TRANSLATIONOPTIONS_HPP_ */
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include "flatzincsupport/VariableMap.hpp"
+
+#include "flatzincsupport/fzexception.hpp"
+
+using namespace std;
+using namespace FZ;
+
+vector<OutputVariable>& FZ::getOutputVariables(){
+	static vector<OutputVariable> outputs;
+	return outputs;
+}
+
+void FZ::renameOutputVariables(const vector<int>& names){
+	vector<OutputVariable>& outputs = getOutputVariables();
+	for(vector<OutputVariable>::iterator i=outputs.begin(); i<outputs.end(); ++i){
+		for(vector<MappedElement>::iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			if((*j).type!=MAP_BOOL && (*j).type!=MAP_INT){
+				continue;
+			}
+			int name = names[(*j).value];
+			if(name!=0){
+				(*j).value = name;
+			}else if((*j).type==MAP_BOOL){
+				(*j).type = MAP_BOOL_VALUE;
+				(*j).value = 0;
+			}else{
+				throw fzexception("Integer output variable is not declared in the output.\n");
+			}
+		}
+	}
+}
+
+const char mapmagic[4] = {'F', 'Z', 'M', '1'};
+
+void writeNumber(ostream& out, int number){
+	unsigned int value = number;
+	char bytes[4] = {(char)(value & 0xff), (char)((value>>8) & 0xff), (char)((value>>16) & 0xff), (char)((value>>24) & 0xff)};
+	out.write(bytes, 4);
+}
+
+int readNumber(istream& in){
+	unsigned char bytes[4];
+	if(!in.read((char*)bytes, 4)){
+		throw fzexception("Incomplete variable map.\n");
+	}
+	return (int)(bytes[0] | (bytes[1]<<8) | (bytes[2]<<16) | ((unsigned int)bytes[3]<<24));
+}
+
+void FZ::writeVariableMap(ostream& out, const vector<OutputVariable>& variables){
+	out.write(mapmagic, 4);
+	writeNumber(out, variables.size());
+	for(vector<OutputVariable>::const_iterator i=variables.begin(); i<variables.end(); ++i){
+		writeNumber(out, (*i).name.size());
+		out.write((*i).name.data(), (*i).name.size());
+		writeNumber(out, (*i).dims.size());
+		for(vector<pair<int, int> >::const_iterator j=(*i).dims.begin(); j<(*i).dims.end(); ++j){
+			writeNumber(out, (*j).first);
+			writeNumber(out, (*j).second);
+		}
+		writeNumber(out, (*i).elements.size());
+		for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			writeNumber(out, (*j).type);
+			writeNumber(out, (*j).value);
+		}
+	}
+}
+
+void FZ::readVariableMap(istream& in, vector<OutputVariable>& variables){
+	char magic[4];
+	if(!in.read(magic, 4) || string(magic, 4)!=string(mapmagic, 4)){
+		throw fzexception("Not a variable map.\n");
+	}
+	int nbvariables = readNumber(in);
+	for(int i=0; i<nbvariables; ++i){
+		OutputVariable variable;
+		int namesize = readNumber(in);
+		if(namesize<0){ throw fzexception("Incorrect variable map.\n"); }
+		variable.name.resize(namesize);
+		if(namesize>0 && !in.read(&variable.name[0], namesize)){
+			throw fzexception("Incomplete variable map.\n");
+		}
+		int nbdims = readNumber(in);
+		for(int j=0; j<nbdims; ++j){
+			int begin = readNumber(in);
+			int end = readNumber(in);
+			variable.dims.push_back(pair<int, int>(begin, end));
+		}
+		int nbelements = readNumber(in);
+		for(int j=0; j<nbelements; ++j){
+			int type = readNumber(in);
+			if(type<MAP_BOOL || type>MAP_INT_VALUE){ throw fzexception("Incorrect variable map.\n"); }
+			int value = readNumber(in);
+			variable.elements.push_back(MappedElement((MAPPED_TYPE)type, value));
+		}
+		variables.push_back(variable);
+	}
+}
+
+SolutionPrinter::SolutionPrinter(const vector<OutputVariable>& variables): variables(variables), model(1){
+}
+
+void SolutionPrinter::assign(int var, int value){
+	if(var<=0){
+		throw fzexception("Incorrect variable in the model.\n");
+	}
+	if((unsigned int)var>=values.size()){
+		values.resize(var+1, 0);
+		stamps.resize(var+1, 0);
+	}
+	values[var] = value;
+	stamps[var] = model;
+}
+
+int SolutionPrinter::getValue(int var) const{
+	if(var<=0 || (unsigned int)var>=stamps.size() || stamps[var]!=model){
+		throw fzexception("The model does not assign an output variable.\n");
+	}
+	return values[var];
+}
+
+void appendInt(int value, string& out){
+	char digits[12];
+	int size = 0;
+	unsigned int rest = value<0?-(unsigned int)value:value;
+	do{
+		digits[size++] = '0'+rest%10;
+		rest /= 10;
+	}while(rest>0);
+	if(value<0){
+		out += '-';
+	}
+	while(size>0){
+		out += digits[--size];
+	}
+}
+
+void SolutionPrinter::printElement(const MappedElement& element, string& out) const{
+	switch(element.type){
+	case MAP_BOOL:
+		out += getValue(element.value)?"true":"false";
+		break;
+	case MAP_BOOL_VALUE:
+		out += element.value?"true":"false";
+		break;
+	case MAP_INT:
+		appendInt(getValue(element.value), out);
+		break;
+	case MAP_INT_VALUE:
+		appendInt(element.value, out);
+		break;
+	}
+}
+
+void SolutionPrinter::printModel(string& out){
+	for(vector<OutputVariable>::const_iterator i=variables.begin(); i<variables.end(); ++i){
+		out += (*i).name;
+		out += " = ";
+		if((*i).dims.size()==0){
+			if((*i).elements.size()!=1){ throw fzexception("Incorrect variable map.\n"); }
+			printElement((*i).elements[0], out);
+		}else{
+			out += "array";
+			appendInt((*i).dims.size(), out);
+			out += "d(";
+			for(vector<pair<int, int> >::const_iterator j=(*i).dims.begin(); j<(*i).dims.end(); ++j){
+				appendInt((*j).first, out);
+				out += "..";
+				appendInt((*j).second, out);
+				out += ", ";
+			}
+			out += "[";
+			for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+				if(j!=(*i).elements.begin()){
+					out += ", ";
+				}
+				printElement(*j, out);
+			}
+			out += "])";
+		}
+		out += ";\n";
+	}
+	out += "----------\n";
+	model++;
+}
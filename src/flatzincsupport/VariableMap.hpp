@@ -0,0 +1,79 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#ifndef VARIABLEMAP_HPP_
+#define VARIABLEMAP_HPP_
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <ostream>
+
+namespace FZ{
+
+/**
+ * Where the value of a flatzinc output variable can be found in an ECNF model.
+ */
+enum MAPPED_TYPE { MAP_BOOL, MAP_BOOL_VALUE, MAP_INT, MAP_INT_VALUE };
+
+struct MappedElement{
+	MAPPED_TYPE type;
+	int value;	// The literal or integer variable, or the value if it is fixed
+
+	MappedElement(MAPPED_TYPE type, int value): type(type), value(value){}
+};
+
+// An output_var has no dimensions, an output_array one index range per dimension
+struct OutputVariable{
+	std::string name;
+	std::vector<std::pair<int, int> > dims;
+	std::vector<MappedElement> elements;
+};
+
+// In declaration order
+std::vector<OutputVariable>& getOutputVariables();
+
+// Variable v becomes names[v], a boolean not in the output (name 0) is free and becomes false
+void renameOutputVariables(const std::vector<int>& names);
+
+/**
+ * The binary sidecar: "FZM1", the number of variables and per variable its name, dimensions and elements.
+ * All numbers are 32 bit little endian.
+ */
+void writeVariableMap(std::ostream& out, const std::vector<OutputVariable>& variables);
+void readVariableMap(std::istream& in, std::vector<OutputVariable>& variables);
+
+/**
+ * Prints solver models as flatzinc solutions.
+ * A model is a sequence of literals and integer assignments "id=value", ended by 0.
+ */
+class SolutionPrinter{
+private:
+	const std::vector<OutputVariable>& variables;
+	std::vector<int> values;
+	std::vector<unsigned int> stamps;	// The model in which the variable got its value
+	unsigned int model;
+
+	void assign(int var, int value);
+	int getValue(int var) const;
+	void printElement(const MappedElement& element, std::string& out) const;
+
+public:
+	SolutionPrinter(const std::vector<OutputVariable>& variables);
+
+	void setLiteral(int lit) { assign(lit<0?-lit:lit, lit>0); }
+	void setInt(int var, int value) { assign(var, value); }
+
+	// Appends the solution of the current model and starts a new one
+	void printModel(std::string& out);
+};
+
+}
+
+#endif /* VARIABLEMAP_HPP_ */
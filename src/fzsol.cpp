@@ -0,0 +1,157 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "flatzincsupport/VariableMap.hpp"
+#include "flatzincsupport/fzexception.hpp"
+using namespace std;
+
+/**
+ * Translates the models an ECNF solver found back into flatzinc solutions, using the variable map written by fz2ecnf --map.
+ */
+
+void usage(){
+	cout << "Usage:\n"
+		 << "   fzsol [-h] mapfile [solverfile]\n\n"
+		 << "Reads the models from solverfile, or stdin if it is not given.\n"
+		 << "Every model is a list of literals and integer assignments id=value, ended by 0.\n"
+		 << "Lines starting with c are comments, a leading v is skipped, a line s UNSATISFIABLE or UNSAT means there are no models.\n";
+}
+
+class Reader{
+private:
+	FILE* in;
+	char buffer[1<<16];
+	size_t position, size;
+
+	void fill(){
+		size = fread(buffer, 1, sizeof(buffer), in);
+		position = 0;
+	}
+public:
+	Reader(FILE* in): in(in), position(0), size(0){}
+
+	int peek(){
+		if(position==size){
+			fill();
+			if(size==0){
+				return EOF;
+			}
+		}
+		return (unsigned char)buffer[position];
+	}
+	void skip(){ position++; }
+
+	void skipLine(){
+		int c;
+		while((c = peek())!=EOF && c!='\n'){
+			skip();
+		}
+	}
+	void readWord(string& word){
+		word.clear();
+		int c;
+		while((c = peek())!=EOF && c!=' ' && c!='\t' && c!='\n' && c!='\r'){
+			word += (char)c;
+			skip();
+		}
+	}
+	int readNumber(){
+		bool negative = false;
+		if(peek()=='-'){
+			negative = true;
+			skip();
+		}
+		if(peek()<'0' || peek()>'9'){
+			throw fzexception("Incorrect solver output.\n");
+		}
+		int number = 0;
+		int c;
+		while((c = peek())>='0' && c<='9'){
+			number = number*10+(c-'0');
+			skip();
+		}
+		return negative?-number:number;
+	}
+};
+
+int main(int argc, char* argv[]) {
+	if(argc<2 || argc>3 || string(argv[1])=="-h" || string(argv[1])=="--help"){
+		usage();
+		return argc>=2?0:1;
+	}
+	try{
+		vector<FZ::OutputVariable> variables;
+		ifstream map(argv[1], ios::in | ios::binary);
+		if(!map){
+			throw fzexception("File could not be opened, aborting.\n");
+		}
+		FZ::readVariableMap(map, variables);
+
+		FILE* in = stdin;
+		if(argc==3 && (in = fopen(argv[2], "r"))==NULL){
+			throw fzexception("File could not be opened, aborting.\n");
+		}
+		Reader reader(in);
+		FZ::SolutionPrinter printer(variables);
+		string out, word;
+		bool unsat = false;
+		int c;
+		while((c = reader.peek())!=EOF){
+			if(c==' ' || c=='\t' || c=='\n' || c=='\r'){
+				reader.skip();
+			}else if(c=='c'){
+				reader.skipLine();
+			}else if(c=='v'){
+				reader.skip();
+			}else if(c=='s' || c=='U'){
+				reader.readWord(word);
+				if(word=="UNSAT" || word=="UNSATISFIABLE"){
+					unsat = true;
+				}else if(word=="s"){
+					while(reader.peek()==' '){
+						reader.skip();
+					}
+					reader.readWord(word);
+					unsat |= word=="UNSATISFIABLE";
+				}
+				reader.skipLine();
+			}else{
+				int number = reader.readNumber();
+				if(reader.peek()=='='){
+					reader.skip();
+					printer.setInt(number, reader.readNumber());
+				}else if(number!=0){
+					printer.setLiteral(number);
+				}else{
+					printer.printModel(out);
+					if(out.size()>(1<<16)){
+						fwrite(out.data(), 1, out.size(), stdout);
+						out.clear();
+					}
+				}
+			}
+		}
+		if(unsat){
+			out += "=====UNSATISFIABLE=====\n";
+		}
+		fwrite(out.data(), 1, out.size(), stdout);
+		if(in!=stdin){
+			fclose(in);
+		}
+	}catch(const fzexception& e){
+		cerr <<e.what();
+		return 1;
+	}
+	return 0;
+}
@@ -8,10 +8,44 @@
  */
 #include <cstdio>
 #include <iostream>
+#include <fstream>
 #include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
 #include "flatzincsupport/FlatZincMX.hpp"
+#include "flatzincsupport/Statistics.hpp"
+#include "flatzincsupport/MemoryStats.hpp"
+#include "flatzincsupport/TranslationCache.hpp"
+#include "flatzincsupport/VariableMap.hpp"
+#include "flatzincsupport/TranslationOptions.hpp"
+#include "flatzincsupport/SearchHints.hpp"
+#include "flatzincsupport/ModelAnalysis.hpp"
+#include "flatzincsupport/EcnfSink.hpp"
+#include "flatzincsupport/StatementBuffer.hpp"
+#include "flatzincsupport/Components.hpp"
 using namespace std;
 
+const char* version = "1.0.0";
+
+struct Options{
+	bool fromstdin;
+	bool analyze;		// Only report the structure of the model
+	bool stats, statsjson;
+	string statsfile;	// Empty for stderr
+	bool memstats, memstatsjson;
+	double meminterval;	// 0 if memory usage is not sampled
+	string mapfile;		// Empty if no variable map is written
+	string hintsfile;	// Empty if no search hints are written
+	string splitprefix;	// Empty if the theory is written to stdout as a whole
+	string cachedir;	// Empty if translations are not cached
+	long long cachesize;
+	int threads;		// 1 if the input is parsed while it is translated
+
+	Options(): fromstdin(false), analyze(false), stats(false), statsjson(false), memstats(false), memstatsjson(false), meminterval(0),
+			cachesize(1024LL*1024*1024), threads(1){}
+};
+
 /**
  * Print help message
  **/
@@ -20,40 +54,221 @@ void usage() {
 		 << "   fz2idp [options] [filename]\n\n";
 	cout << "Options:\n";
 	cout << "    -v, --version        show version number and stop\n";
-	cout << "    -h, --help           show this help message\n\n";
+	cout << "    -h, --help           show this help message\n";
+	cout << "    --analyze            report the structure and the estimated translation size of the model as JSON, without translating\n";
+	cout << "    --stats[=json]       report timing, constraint, auxiliary variable and output statistics\n";
+	cout << "    --stats-file=FILE    write the statistics to FILE instead of stderr\n";
+	cout << "    --memstats[=json]    report current and peak memory per subsystem at exit on stderr\n";
+	cout << "    --memstats-interval=SECONDS\n";
+	cout << "                         also print the memory per subsystem every SECONDS on stderr\n";
+	cout << "                         (memory statistics need a build configured with --enable-memstats)\n";
+	cout << "    --renumber=ORDER     renumber the variables so those in the same constraints are close: bfs or rcm\n";
+	cout << "    --no-pb-fusion       keep linear constraints over bool2int channels as integer sums\n";
+	cout << "    --no-half-reify      write every reified constraint as an equivalence, also if its literal occurs in one polarity\n";
+	cout << "    --expand-domains=N   write comparisons of integers with at most N values as clauses over value literals (8, 0 never)\n";
+	cout << "    --compact            number only the variables in the output, consecutively\n";
+	cout << "    --map=FILE           write the ECNF variables of the output variables to FILE, for fzsol\n";
+	cout << "    --hints=FILE         write the search annotations of the model as ECNF variables to FILE\n";
+	cout << "    --split=PREFIX       write each independent component to PREFIX-N.ecnf, listed in PREFIX.manifest\n";
+	cout << "    --threads=N          parse chunks of an input file on N threads while translating (1)\n";
+	cout << "    --cache-dir=DIR      reuse the translation of identical input stored in DIR, and store new ones there\n";
+	cout << "    --cache-size=MB      evict the least recently used translations when DIR exceeds MB megabytes (1024)\n\n";
 }
 
 /** 
  * Parse command line options 
  **/
-string read_options(int argc, char* argv[], bool& fromstdin) {
+string read_options(int argc, char* argv[], Options& options) {
 	string inputfile;
 	argc--; argv++;
 	int filesfound = 0;
-	fromstdin = false;
+	options.fromstdin = false;
 	while(argc) {
 		string str(argv[0]);
 		argc--; argv++;
-		if(str == "-v" || str == "--version")		{ cout << "fz2fodot 1.0.0\n"; exit(0);		}
+		if(str == "-v" || str == "--version")		{ cout << "fz2fodot " <<version <<"\n"; exit(0);	}
 		else if(str == "-h" || str == "--help")		{ usage(); exit(0);							}
+		else if(str == "--analyze")					{ options.analyze = true;					}
+		else if(str == "--stats")					{ options.stats = true;						}
+		else if(str == "--stats=json")				{ options.stats = true; options.statsjson = true; }
+		else if(str.compare(0, 13, "--stats-file=")==0)	{ options.stats = true; options.statsfile = str.substr(13); }
+		else if(str == "--memstats")				{ options.memstats = true;					}
+		else if(str == "--memstats=json")			{ options.memstats = true; options.memstatsjson = true; }
+		else if(str.compare(0, 20, "--memstats-interval=")==0)	{ options.meminterval = atof(str.substr(20).c_str()); }
+		else if(str == "--renumber=bfs")			{ FZ::getTranslationOptions().renumbering = FZ::RENUMBER_BFS; }
+		else if(str == "--renumber=rcm")			{ FZ::getTranslationOptions().renumbering = FZ::RENUMBER_RCM; }
+		else if(str == "--no-pb-fusion")			{ FZ::getTranslationOptions().pbfusion = false; }
+		else if(str == "--no-half-reify")			{ FZ::getTranslationOptions().halfreify = false; }
+		else if(str.compare(0, 17, "--expand-domains=")==0)	{ FZ::getTranslationOptions().expanddomains = atoi(str.substr(17).c_str()); }
+		else if(str == "--compact")					{ FZ::getTranslationOptions().compact = true; }
+		else if(str.compare(0, 6, "--map=")==0)	{ options.mapfile = str.substr(6);		}
+		else if(str.compare(0, 8, "--hints=")==0)	{ options.hintsfile = str.substr(8);		}
+		else if(str.compare(0, 8, "--split=")==0)	{ options.splitprefix = str.substr(8);	}
+		else if(str.compare(0, 10, "--threads=")==0)	{ options.threads = max(1, atoi(str.substr(10).c_str())); }
+		else if(str.compare(0, 12, "--cache-dir=")==0)	{ options.cachedir = str.substr(12);		}
+		else if(str.compare(0, 13, "--cache-size=")==0)	{ options.cachesize = atoll(str.substr(13).c_str())*1024*1024; }
 		else if(str[0] == '-')						{ cerr <<"Unknown option " <<str; exit(0);	}
 		else										{ inputfile = str;	filesfound++; 			}
 	}
 	if(filesfound==0){
-		fromstdin = true;
+		options.fromstdin = true;
 	}else if(filesfound!=1){
 		usage(); exit(0);
 	}
 	return inputfile;
 }
 
-int main(int argc, char* argv[]) {
-	bool fromstdin = false;
-	string inputfile = read_options(argc,argv, fromstdin);
+void writeStatistics(const Options& options){
+	if(options.statsfile.empty()){
+		FZ::getStatistics().write(cerr, options.statsjson);
+		return;
+	}
+	ofstream out(options.statsfile.c_str());
+	if(!out){
+		cerr <<"Could not open " <<options.statsfile <<" to write the statistics.\n";
+		return;
+	}
+	FZ::getStatistics().write(out, options.statsjson);
+}
+
+void writeVariableMap(const Options& options, streambuf* cached){
+	ofstream out(options.mapfile.c_str(), ios::out | ios::binary);
+	if(!out){
+		cerr <<"Could not open " <<options.mapfile <<" to write the variable map.\n";
+		return;
+	}
+	FZ::writeVariableMap(out, FZ::getOutputVariables());
+	if(cached!=NULL){
+		ostream cache(cached);
+		FZ::writeVariableMap(cache, FZ::getOutputVariables());
+	}
+}
+
+void writeSearchHints(const Options& options, streambuf* cached){
+	ofstream out(options.hintsfile.c_str());
+	if(!out){
+		cerr <<"Could not open " <<options.hintsfile <<" to write the search hints.\n";
+		return;
+	}
+	FZ::writeSearchHints(out, FZ::getSearchHints());
+	if(cached!=NULL){
+		ostream cache(cached);
+		FZ::writeSearchHints(cache, FZ::getSearchHints());
+	}
+}
 
+// Copies the cached file with extension ext to file
+bool sendCached(FZ::TranslationCache& cache, const string& key, const char* ext, const string& file){
+	int out = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	bool cached = out>=0 && cache.send(key, ext, out);
+	if(out>=0){
+		close(out);
+	}
+	return cached;
+}
+
+// Returns false if the cache directory cannot be used
+bool translateCached(const Options& options, const string& inputfile){
+	FZ::TranslationCache cache(options.cachedir, options.cachesize);
+	if(!cache.isUsable()){
+		cerr <<"Cache directory " <<options.cachedir <<" cannot be used, translating without cache.\n";
+		return false;
+	}
+	string input;
+	FZ::readInput(options.fromstdin, inputfile, input);
+	string key = cache.getKey(input, string("fz2ecnf ")+version+" "+FZ::getTranslationOptions().getKey());
+	cout.flush();
+	if((options.mapfile.empty() || sendCached(cache, key, ".map", options.mapfile))
+			&& (options.hintsfile.empty() || sendCached(cache, key, ".hints", options.hintsfile))
+			&& cache.send(key, ".ecnf", STDOUT_FILENO)){
+		return true;
+	}
+
+	FZ::CacheEntry entry(cache, key, ".ecnf");
+	FZ::TeeBuffer tee(cout.rdbuf(), entry.getBuffer());
+	streambuf* original = cout.rdbuf();
+	if(entry.isOpen()){
+		cout.rdbuf(&tee);
+	}
 	FZ::FlatZincMX* mx = new FZ::FlatZincMX();
-	mx->parse(fromstdin, inputfile);
+	mx->setThreads(options.threads);
+	try{
+		mx->parse(input);
+		mx->writeout();
+		cout.flush();
+	}catch(...){
+		cout.rdbuf(original);
+		delete(mx);
+		throw;
+	}
+	cout.rdbuf(original);
+	delete(mx);
+	if(entry.isOpen() && tee.isSecondComplete()){
+		entry.commit();
+	}
+	if(!options.mapfile.empty()){
+		FZ::CacheEntry mapentry(cache, key, ".map");
+		writeVariableMap(options, mapentry.isOpen()?mapentry.getBuffer():NULL);
+		if(mapentry.isOpen()){
+			mapentry.commit();
+		}
+	}
+	if(!options.hintsfile.empty()){
+		FZ::CacheEntry hintsentry(cache, key, ".hints");
+		writeSearchHints(options, hintsentry.isOpen()?hintsentry.getBuffer():NULL);
+		if(hintsentry.isOpen()){
+			hintsentry.commit();
+		}
+	}
+	return true;
+}
+
+// The theory is kept in memory and written per component, the variable map and search hints are those of the whole theory
+void translateSplit(const Options& options, const string& inputfile){
+	FZ::StatementBuffer statements;
+	FZ::FlatZincMX* mx = new FZ::FlatZincMX(statements);
+	mx->setThreads(options.threads);
+	mx->parse(options.fromstdin, inputfile);
 	mx->writeout();
 	delete(mx);
+	FZ::splitComponents(statements, options.splitprefix);
+	if(!options.mapfile.empty()){
+		writeVariableMap(options, NULL);
+	}
+	if(!options.hintsfile.empty()){
+		writeSearchHints(options, NULL);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	string inputfile = read_options(argc,argv, options);
+	FZ::getStatistics().enabled = options.stats;
+	FZ::setMemorySampling(options.meminterval);
+
+	if(options.analyze){
+		FZ::analyzeModel(options.fromstdin, inputfile, cout);
+	}else if(!options.splitprefix.empty()){
+		translateSplit(options, inputfile);
+	}else if(options.cachedir.empty() || !translateCached(options, inputfile)){
+		FZ::FlatZincMX* mx = new FZ::FlatZincMX();
+		mx->setThreads(options.threads);
+		mx->parse(options.fromstdin, inputfile);
+		mx->writeout();
+		delete(mx);
+		if(!options.mapfile.empty()){
+			writeVariableMap(options, NULL);
+		}
+		if(!options.hintsfile.empty()){
+			writeSearchHints(options, NULL);
+		}
+	}
+
+	if(options.stats){
+		writeStatistics(options);
+	}
+	if(options.memstats){
+		FZ::writeMemoryUsage(cerr, options.memstatsjson);
+	}
 	return 0;
 }
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2011 Katholieke Universiteit Leuven
+ *
+ * Use of this software is governed by the GNU LGPLv3.0 license
+ *
+ * Written by Broes De Cat, K.U.Leuven, Departement
+ * Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+ */
+#include <cstdlib>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include "flatzincsupport/EcnfSink.hpp"
+#include "flatzincsupport/EcnfScanner.hpp"
+#include "flatzincsupport/VariableMap.hpp"
+#include "flatzincsupport/fzexception.hpp"
+using namespace std;
+using namespace FZ;
+
+/**
+ * Enumerates the solutions of a small ECNF theory by backtracking, to test the translator against itself.
+ * Prints the distinct solutions projected onto the output variables of the map, sorted, and if the theory has
+ * a Mnmlist only the optimal ones. Meant for theories of a few dozen variables, inductive definitions are not supported.
+ */
+
+void usage(){
+	cout << "Usage:\n"
+		 << "   ecnfenum [-h] mapfile [ecnffile]\n\n"
+		 << "Reads the ECNF theory written by fz2ecnf from ecnffile, or stdin if it is not given,\n"
+		 << "and prints its solutions as flatzinc, using the variable map written by fz2ecnf --map.\n";
+}
+
+enum STATEMENT { ST_CLAUSE, ST_EQUIV, ST_COMPARISON, ST_VARCOMPARISON, ST_LINEAR, ST_AGGREGATE };
+
+struct Statement{
+	STATEMENT type;
+	int head;
+	bool conj;			// Equivalences: conjunction, aggregates: at most bound
+	COMPARISON op;
+	int bound;			// Also the value of a comparison and the set of an aggregate
+	AGGREGATE aggregate;
+	vector<int> lits;	// The body, or the variables of a comparison or linear sum
+	vector<int> weights;
+};
+
+struct LiteralSet{
+	vector<int> lits, weights;
+};
+
+bool compare(long long left, COMPARISON op, long long right){
+	switch(op){
+	case COMP_EQ: return left==right;
+	case COMP_NE: return left!=right;
+	case COMP_LT: return left<right;
+	case COMP_LE: return left<=right;
+	case COMP_GT: return left>right;
+	default: return left>=right;
+	}
+}
+
+class Enumerator: public EcnfSink{
+private:
+	vector<Statement> statements;
+	map<int, LiteralSet> sets;
+	vector<int> minimize;
+	map<int, vector<int> > domains;	// The integer variables, booleans are not declared
+	int maxvar;
+
+	vector<int> order;					// The variables in the order they are assigned
+	vector<int> position;				// The position of each variable in order
+	vector<vector<int> > checks;		// Per position, the statements whose last variable is assigned there
+	vector<int> values;
+	unsigned int nbprojected;
+	int best;
+
+	void addVar(int lit){
+		if(abs(lit)>maxvar){
+			maxvar = abs(lit);
+		}
+	}
+	void add(const Statement& statement){
+		addVar(statement.head);
+		for(vector<int>::const_iterator i=statement.lits.begin(); i<statement.lits.end(); ++i){
+			addVar(*i);
+		}
+		statements.push_back(statement);
+	}
+
+	bool isTrue(int lit) const { return lit>0?values[lit]!=0:values[-lit]==0; }
+	const LiteralSet& getSet(int setid) const{
+		map<int, LiteralSet>::const_iterator set = sets.find(setid);
+		if(set==sets.end()){ throw fzexception("Aggregate over an undeclared set.\n"); }
+		return (*set).second;
+	}
+	bool holds(const Statement& statement) const;
+	void getVariables(const Statement& statement, vector<int>& vars) const;
+	void placeAfterInputs(int var, const vector<int>& definitions, vector<bool>& placed);
+	bool assign(unsigned int index, int value);
+	int getObjective() const;
+	bool extend(unsigned int index);
+	void project(unsigned int index, map<string, int>& solutions, const vector<OutputVariable>& outputs);
+
+public:
+	Enumerator(): maxvar(0), nbprojected(0), best(INT_MAX){}
+
+	void addClause(Span<int> lits){
+		Statement statement;
+		statement.type = ST_CLAUSE;
+		statement.head = 0;
+		statement.lits.assign(lits.begin(), lits.end());
+		add(statement);
+	}
+	void addEquivalence(int head, bool conj, Span<int> body){
+		Statement statement;
+		statement.type = ST_EQUIV;
+		statement.head = head;
+		statement.conj = conj;
+		statement.lits.assign(body.begin(), body.end());
+		add(statement);
+	}
+	void addRule(int, int, bool, Span<int>){ throw fzexception("Inductive definitions are not supported.\n"); }
+	void addIntVar(int var, int lower, int upper){
+		addVar(var);
+		vector<int>& domain = domains[var];
+		for(long long i=lower; i<=upper; ++i){
+			domain.push_back(i);
+		}
+	}
+	void addIntVar(int var, Span<int> domain){
+		addVar(var);
+		domains[var].assign(domain.begin(), domain.end());
+	}
+	void addComparison(int head, int var, COMPARISON op, int value){
+		Statement statement;
+		statement.type = ST_COMPARISON;
+		statement.head = head;
+		statement.op = op;
+		statement.bound = value;
+		statement.lits.push_back(var);
+		add(statement);
+	}
+	void addVarComparison(int head, int var, COMPARISON op, int var2){
+		Statement statement;
+		statement.type = ST_VARCOMPARISON;
+		statement.head = head;
+		statement.op = op;
+		statement.lits.push_back(var);
+		statement.lits.push_back(var2);
+		add(statement);
+	}
+	void addLinear(int head, Span<int> vars, Span<int> weights, COMPARISON op, int bound){
+		Statement statement;
+		statement.type = ST_LINEAR;
+		statement.head = head;
+		statement.op = op;
+		statement.bound = bound;
+		statement.lits.assign(vars.begin(), vars.end());
+		statement.weights.assign(weights.begin(), weights.end());
+		add(statement);
+	}
+	void addSet(int setid, Span<int> lits, Span<int> weights){
+		LiteralSet& set = sets[setid];
+		set.lits.assign(lits.begin(), lits.end());
+		set.weights.assign(weights.begin(), weights.end());
+		for(const int* i=lits.begin(); i<lits.end(); ++i){
+			addVar(*i);
+		}
+	}
+	void addAggregate(AGGREGATE type, int head, int setid, bool upper, int bound){
+		Statement statement;
+		statement.type = ST_AGGREGATE;
+		statement.aggregate = type;
+		statement.head = head;
+		statement.conj = upper;
+		statement.bound = setid;
+		statement.weights.push_back(bound);
+		add(statement);
+	}
+	void addMinimize(Span<int> lits){
+		if(minimize.size()>0){ throw fzexception("Only one Mnmlist is supported.\n"); }
+		minimize.assign(lits.begin(), lits.end());
+		for(const int* i=lits.begin(); i<lits.end(); ++i){
+			addVar(*i);
+		}
+	}
+
+	// Prints the solutions projected onto the outputs, the optimal ones if there is a Mnmlist
+	void enumerate(const vector<OutputVariable>& outputs, string& out);
+};
+
+bool Enumerator::holds(const Statement& statement) const{
+	bool value = false;
+	switch(statement.type){
+	case ST_CLAUSE:
+		for(vector<int>::const_iterator i=statement.lits.begin(); i<statement.lits.end(); ++i){
+			if(isTrue(*i)){
+				return true;
+			}
+		}
+		return false;
+	case ST_EQUIV:
+		value = statement.conj;
+		for(vector<int>::const_iterator i=statement.lits.begin(); i<statement.lits.end(); ++i){
+			if(isTrue(*i)!=statement.conj){
+				value = !statement.conj;
+				break;
+			}
+		}
+		break;
+	case ST_COMPARISON:
+		value = compare(values[statement.lits[0]], statement.op, statement.bound);
+		break;
+	case ST_VARCOMPARISON:
+		value = compare(values[statement.lits[0]], statement.op, values[statement.lits[1]]);
+		break;
+	case ST_LINEAR:{
+		long long sum = 0;
+		for(unsigned int i=0; i<statement.lits.size(); ++i){
+			sum += (long long)statement.weights[i]*values[statement.lits[i]];
+		}
+		value = compare(sum, statement.op, statement.bound);
+		break;}
+	case ST_AGGREGATE:{
+		const LiteralSet& set = getSet(statement.bound);
+		long long sum = 0;
+		for(unsigned int i=0; i<set.lits.size(); ++i){
+			if(isTrue(set.lits[i])){
+				sum += statement.aggregate==AGG_CARD || set.weights.size()==0?1:set.weights[i];
+			}
+		}
+		value = statement.conj?sum<=statement.weights[0]:sum>=statement.weights[0];
+		break;}
+	}
+	return isTrue(statement.head)==value;
+}
+
+void Enumerator::getVariables(const Statement& statement, vector<int>& vars) const{
+	vars.clear();
+	if(statement.type!=ST_CLAUSE){
+		vars.push_back(abs(statement.head));
+	}
+	const vector<int>& lits = statement.type==ST_AGGREGATE?getSet(statement.bound).lits:statement.lits;
+	for(vector<int>::const_iterator i=lits.begin(); i<lits.end(); ++i){
+		vars.push_back(abs(*i));
+	}
+}
+
+// A head goes after the variables it depends on, so it is fixed as soon as it is assigned
+void Enumerator::placeAfterInputs(int var, const vector<int>& definitions, vector<bool>& placed){
+	if(placed[var]){
+		return;
+	}
+	placed[var] = true;
+	if(definitions[var]>=0){
+		vector<int> vars;
+		getVariables(statements[definitions[var]], vars);
+		for(vector<int>::const_iterator i=vars.begin()+1; i<vars.end(); ++i){
+			placeAfterInputs(*i, definitions, placed);
+		}
+	}
+	position[var] = order.size();
+	order.push_back(var);
+}
+
+bool Enumerator::assign(unsigned int index, int value){
+	values[order[index]] = value;
+	for(vector<int>::const_iterator i=checks[index].begin(); i<checks[index].end(); ++i){
+		if(!holds(statements[*i])){
+			return false;
+		}
+	}
+	return true;
+}
+
+// The position of the first true literal of the Mnmlist
+int Enumerator::getObjective() const{
+	for(unsigned int i=0; i<minimize.size(); ++i){
+		if(isTrue(minimize[i])){
+			return i;
+		}
+	}
+	return minimize.size();
+}
+
+// Finds the best model with the current projection, returns true if it cannot get better
+bool Enumerator::extend(unsigned int index){
+	if(index==order.size()){
+		int objective = getObjective();
+		if(objective<best){
+			best = objective;
+		}
+		return best==0;
+	}
+	int var = order[index];
+	map<int, vector<int> >::const_iterator domain = domains.find(var);
+	if(domain==domains.end()){
+		for(int value=0; value<2; ++value){
+			if(assign(index, value) && extend(index+1)){
+				return true;
+			}
+		}
+	}else{
+		for(vector<int>::const_iterator i=(*domain).second.begin(); i<(*domain).second.end(); ++i){
+			if(assign(index, *i) && extend(index+1)){
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void Enumerator::project(unsigned int index, map<string, int>& solutions, const vector<OutputVariable>& outputs){
+	if(index==nbprojected){
+		best = INT_MAX;
+		extend(index);
+		if(best==INT_MAX){
+			return;
+		}
+		SolutionPrinter printer(outputs);
+		for(unsigned int i=0; i<nbprojected; ++i){
+			if(domains.find(order[i])==domains.end()){
+				printer.setLiteral(values[order[i]]!=0?order[i]:-order[i]);
+			}else{
+				printer.setInt(order[i], values[order[i]]);
+			}
+		}
+		string solution;
+		printer.printModel(solution);
+		solutions[solution] = best;
+		return;
+	}
+	int var = order[index];
+	map<int, vector<int> >::const_iterator domain = domains.find(var);
+	if(domain==domains.end()){
+		for(int value=0; value<2; ++value){
+			if(assign(index, value)){
+				project(index+1, solutions, outputs);
+			}
+		}
+	}else{
+		for(vector<int>::const_iterator i=(*domain).second.begin(); i<(*domain).second.end(); ++i){
+			if(assign(index, *i)){
+				project(index+1, solutions, outputs);
+			}
+		}
+	}
+}
+
+void Enumerator::enumerate(const vector<OutputVariable>& outputs, string& out){
+	for(vector<OutputVariable>::const_iterator i=outputs.begin(); i<outputs.end(); ++i){
+		for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			if((*j).type==MAP_BOOL || (*j).type==MAP_INT){
+				addVar((*j).value);
+			}
+		}
+	}
+
+	// The output variables first, then the integers, then the booleans after the variables they depend on
+	vector<int> definitions(maxvar+1, -1);
+	for(unsigned int s=0; s<statements.size(); ++s){
+		if(statements[s].type!=ST_CLAUSE && definitions[abs(statements[s].head)]<0){
+			definitions[abs(statements[s].head)] = s;
+		}
+	}
+	position.assign(maxvar+1, -1);
+	vector<bool> placed(maxvar+1, false);
+	for(vector<OutputVariable>::const_iterator i=outputs.begin(); i<outputs.end(); ++i){
+		for(vector<MappedElement>::const_iterator j=(*i).elements.begin(); j<(*i).elements.end(); ++j){
+			if(((*j).type==MAP_BOOL || (*j).type==MAP_INT) && !placed[abs((*j).value)]){
+				placed[abs((*j).value)] = true;
+				position[abs((*j).value)] = order.size();
+				order.push_back(abs((*j).value));
+			}
+		}
+	}
+	nbprojected = order.size();
+	for(map<int, vector<int> >::const_iterator i=domains.begin(); i!=domains.end(); ++i){
+		if(!placed[(*i).first]){
+			placed[(*i).first] = true;
+			position[(*i).first] = order.size();
+			order.push_back((*i).first);
+		}
+	}
+	for(int var=1; var<=maxvar; ++var){
+		placeAfterInputs(var, definitions, placed);
+	}
+
+	checks.assign(order.size()+1, vector<int>());
+	vector<int> vars;
+	for(unsigned int s=0; s<statements.size(); ++s){
+		getVariables(statements[s], vars);
+		int last = -1;
+		for(vector<int>::const_iterator i=vars.begin(); i<vars.end(); ++i){
+			if(position[*i]>last){
+				last = position[*i];
+			}
+		}
+		if(last<0){
+			if(!holds(statements[s])){ return; }
+			continue;
+		}
+		checks[last].push_back(s);
+	}
+
+	values.assign(maxvar+1, 0);
+	map<string, int> solutions;
+	project(0, solutions, outputs);
+	int optimum = INT_MAX;
+	for(map<string, int>::const_iterator i=solutions.begin(); i!=solutions.end(); ++i){
+		if((*i).second<optimum){
+			optimum = (*i).second;
+		}
+	}
+	for(map<string, int>::const_iterator i=solutions.begin(); i!=solutions.end(); ++i){
+		if((*i).second==optimum){
+			out += (*i).first;
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if(argc<2 || argc>3 || string(argv[1])=="-h" || string(argv[1])=="--help"){
+		usage();
+		return argc>=2?0:1;
+	}
+	try{
+		vector<OutputVariable> outputs;
+		ifstream map(argv[1], ios::in | ios::binary);
+		if(!map){
+			throw fzexception("File could not be opened, aborting.\n");
+		}
+		readVariableMap(map, outputs);
+
+		ifstream file;
+		if(argc==3){
+			file.open(argv[2]);
+			if(!file){
+				throw fzexception("File could not be opened, aborting.\n");
+			}
+		}
+		istream& in = argc==3?file:cin;
+		stringstream theory;
+		theory <<in.rdbuf();
+		Enumerator enumerator;
+		parseStatements(theory.str(), enumerator);
+		string out;
+		enumerator.enumerate(outputs, out);
+		if(out.size()==0){
+			out = "=====UNSATISFIABLE=====\n";
+		}
+		cout <<out;
+	}catch(const fzexception& e){
+		cerr <<e.what();
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Copyright 2011 Katholieke Universiteit Leuven
+# Use of this software is governed by the GNU LGPLv3.0 license
+# Written by Broes De Cat, K.U.Leuven, Departement
+# Computerwetenschappen, Celestijnenlaan 200A, B-3001 Leuven, Belgium
+#
+# Checks that writing comparisons of small-domain integers as clauses keeps the solutions of the models in
+# tests/expanddomains: their solutions projected onto the output variables, only the optimal ones for an optimization,
+# are the same as with --expand-domains=0.
+# Run by "make check", which sets srcdir, FZ2ECNF and ECNFENUM.
+
+FZ2ECNF=${FZ2ECNF:-./fz2ecnf}
+ECNFENUM=${ECNFENUM:-./ecnfenum}
+
+DIR=`mktemp -d ${TMPDIR:-/tmp}/expanddomains.XXXXXX` || exit 1
+trap 'rm -rf "$DIR"' 0 1 2 15
+
+STATUS=0
+for MODEL in "${srcdir:-.}"/tests/expanddomains/*.fzn; do
+	NAME=`basename "$MODEL"`
+	for OPTION in "" --expand-domains=0; do
+		$FZ2ECNF $OPTION --map="$DIR/$NAME$OPTION.map" "$MODEL" > "$DIR/$NAME$OPTION.ecnf" || exit 1
+		$ECNFENUM "$DIR/$NAME$OPTION.map" "$DIR/$NAME$OPTION.ecnf" > "$DIR/$NAME$OPTION.sol" || exit 1
+	done
+	if cmp -s "$DIR/$NAME.sol" "$DIR/$NAME--expand-domains=0.sol"; then
+		echo "ok $NAME"
+	else
+		echo "FAIL $NAME: the solutions differ with and without expanding the domains"
+		diff "$DIR/$NAME--expand-domains=0.sol" "$DIR/$NAME.sol"
+		STATUS=1
+	fi
+done
+exit $STATUS